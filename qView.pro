@@ -3,7 +3,7 @@
 TARGET = qView
 VERSION = 4.0
 
-QT += core gui network widgets
+QT += core gui network widgets concurrent
 
 TEMPLATE = app
 
@@ -74,6 +74,18 @@ macx {
     }
 }
 
+# Archive support uses zlib to inflate zip members, stored zip members and tar work without it
+# To build without zlib: qmake CONFIG+=NO_ARCHIVE
+!CONFIG(NO_ARCHIVE) {
+    win32 {
+        QT += zlib-private
+    } else {
+        LIBS += -lz
+    }
+    DEFINES += ARCHIVE_LOADED
+    message("Linked to zlib")
+}
+
 # Stuff for make install
 # To use a custom prefix: qmake PREFIX=/usr
 # An environment variable will also work: PREFIX=/usr qmake
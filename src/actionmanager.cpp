@@ -19,7 +19,8 @@ ActionManager::ActionManager(QObject *parent) : QObject(parent)
     recentsSaveTimer->setInterval(500);
     connect(recentsSaveTimer, &QTimer::timeout, this, &ActionManager::saveRecentsList);
 
-    loadRecentsList();
+    // Checking that each recent file still exists is left for after startup
+    readRecentsList();
 
 #ifdef COCOA_LOADED
     windowMenu = new QMenu(tr("Window"));
@@ -232,6 +233,8 @@ QMenuBar *ActionManager::buildMenuBar(QWidget *parent)
     goMenu->addAction(cloneAction("previousfile"));
     goMenu->addAction(cloneAction("nextfile"));
     goMenu->addAction(cloneAction("lastfile"));
+    goMenu->addSeparator();
+    goMenu->addAction(cloneAction("gotofile"));
 
     menuBar->addMenu(goMenu);
     // End of go menu
@@ -272,6 +275,7 @@ QMenu *ActionManager::buildViewMenu(bool addIcon, QWidget *parent)
     viewMenu->addAction(cloneAction("flip"));
     viewMenu->addSeparator();
     viewMenu->addAction(cloneAction("fullscreen"));
+    viewMenu->addAction(cloneAction("thumbnails"));
 
     menuCloneLibrary.insert(viewMenu->menuAction()->data().toString(), viewMenu);
     return viewMenu;
@@ -353,13 +357,17 @@ void ActionManager::loadRecentsList()
     if (recentsSaveTimer->isActive())
         return;
 
+    readRecentsList();
+    auditRecentsList();
+}
+
+void ActionManager::readRecentsList()
+{
     QSettings settings;
     settings.beginGroup("recents");
 
     QVariantList variantListRecents = settings.value("recentFiles").toList();
     recentsList = variantListToRecentsList(variantListRecents);
-
-    auditRecentsList();
 }
 
 void ActionManager::saveRecentsList()
@@ -626,6 +634,8 @@ void ActionManager::actionTriggered(QAction *triggeredAction, MainWindow *releva
         relevantWindow->flip();
     } else if (key == "fullscreen") {
         relevantWindow->toggleFullScreen();
+    } else if (key == "thumbnails") {
+        relevantWindow->toggleThumbnails();
     } else if (key == "firstfile") {
         relevantWindow->firstFile();
     } else if (key == "previousfile") {
@@ -634,6 +644,8 @@ void ActionManager::actionTriggered(QAction *triggeredAction, MainWindow *releva
         relevantWindow->nextFile();
     } else if (key == "lastfile") {
         relevantWindow->lastFile();
+    } else if (key == "gotofile") {
+        relevantWindow->goToFile();
     } else if (key == "saveframeas") {
         relevantWindow->saveFrameAs();
     } else if (key == "pause") {
@@ -684,7 +696,7 @@ void ActionManager::initializeActionLibrary()
     //: Open containing folder on macOS
     openContainingFolderAction->setText(tr("Show in &Finder"));
 #endif
-    openContainingFolderAction->setData({"disable"});
+    openContainingFolderAction->setData({"filedisable"});
     actionLibrary.insert("opencontainingfolder", openContainingFolderAction);
 
     auto *showFileInfoAction = new QAction(QIcon::fromTheme("document-properties"), tr("Show File &Info"));
@@ -695,7 +707,7 @@ void ActionManager::initializeActionLibrary()
 #ifdef Q_OS_WIN
     deleteAction->setText(tr("&Delete"));
 #endif
-    deleteAction->setData({"disable"});
+    deleteAction->setData({"filedisable"});
     actionLibrary.insert("delete", deleteAction);
 
     auto *undoAction = new QAction(QIcon::fromTheme("edit-undo"), tr("&Restore from Trash"));
@@ -713,7 +725,7 @@ void ActionManager::initializeActionLibrary()
     actionLibrary.insert("paste", pasteAction);
 
     auto *renameAction = new QAction(QIcon::fromTheme("edit-rename", QIcon::fromTheme("document-properties")) , tr("R&ename..."));
-    renameAction->setData({"disable"});
+    renameAction->setData({"filedisable"});
     actionLibrary.insert("rename", renameAction);
 
     auto *zoomInAction = new QAction(QIcon::fromTheme("zoom-in"), tr("Zoom &In"));
@@ -752,6 +764,10 @@ void ActionManager::initializeActionLibrary()
     fullScreenAction->setMenuRole(QAction::NoRole);
     actionLibrary.insert("fullscreen", fullScreenAction);
 
+    auto *thumbnailsAction = new QAction(QIcon::fromTheme("view-preview"), tr("Show &Thumbnails"));
+    thumbnailsAction->setData({"folderdisable"});
+    actionLibrary.insert("thumbnails", thumbnailsAction);
+
     auto *firstFileAction = new QAction(QIcon::fromTheme("go-first"), tr("&First File"));
     firstFileAction->setData({"folderdisable"});
     actionLibrary.insert("firstfile", firstFileAction);
@@ -768,6 +784,10 @@ void ActionManager::initializeActionLibrary()
     lastFileAction->setData({"folderdisable"});
     actionLibrary.insert("lastfile", lastFileAction);
 
+    auto *goToFileAction = new QAction(QIcon::fromTheme("go-jump"), tr("&Go to File..."));
+    goToFileAction->setData({"folderdisable"});
+    actionLibrary.insert("gotofile", goToFileAction);
+
     auto *saveFrameAsAction = new QAction(QIcon::fromTheme("document-save-as"), tr("Save Frame &As..."));
     saveFrameAsAction->setData({"gifdisable"});
     actionLibrary.insert("saveframeas", saveFrameAsAction);
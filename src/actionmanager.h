@@ -140,6 +140,8 @@ signals:
 protected:
     void initializeActionLibrary();
 
+    void readRecentsList();
+
 private:
     QHash<QString, QAction*> actionLibrary;
 
@@ -0,0 +1,410 @@
+#include "archivereader.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QCache>
+#include <QMutex>
+#include <QtEndian>
+#include <climits>
+
+#ifdef ARCHIVE_LOADED
+#ifdef Q_OS_WIN
+#include <QtZlib/zlib.h>
+#else
+#include <zlib.h>
+#endif
+#endif
+
+namespace
+{
+    const QStringList zipSuffixes = {"zip", "cbz"};
+    const QStringList tarSuffixes = {"tar", "cbt"};
+    const QStringList archiveSuffixes = zipSuffixes + tarSuffixes;
+
+    quint16 readUInt16(const char *data)
+    {
+        return qFromLittleEndian<quint16>(reinterpret_cast<const uchar*>(data));
+    }
+
+    quint32 readUInt32(const char *data)
+    {
+        return qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(data));
+    }
+
+    quint64 readUInt64(const char *data)
+    {
+        return qFromLittleEndian<quint64>(reinterpret_cast<const uchar*>(data));
+    }
+
+    qint64 readTarNumber(const QByteArray &field)
+    {
+        // Big sizes are stored in base-256 with the high bit set instead of in octal
+        if (!field.isEmpty() && (static_cast<uchar>(field.at(0)) & 0x80))
+        {
+            qint64 value = static_cast<uchar>(field.at(0)) & 0x7f;
+            for (int i = 1; i < field.size(); i++)
+                value = (value << 8) | static_cast<uchar>(field.at(i));
+            return value;
+        }
+
+        QByteArray octal = field;
+        const int nullIndex = octal.indexOf('\0');
+        if (nullIndex != -1)
+            octal.truncate(nullIndex);
+        return octal.trimmed().toLongLong(nullptr, 8);
+    }
+
+    QString readTarString(const QByteArray &field)
+    {
+        const int nullIndex = field.indexOf('\0');
+        return QFile::decodeName(nullIndex == -1 ? field : field.left(nullIndex));
+    }
+}
+
+bool ArchiveReader::isArchive(const QString &filePath)
+{
+    const QFileInfo fileInfo(filePath);
+    const QString suffix = fileInfo.suffix().toLower();
+    return (zipSuffixes.contains(suffix) || tarSuffixes.contains(suffix)) && fileInfo.isFile();
+}
+
+bool ArchiveReader::isArchiveMember(const QString &path)
+{
+    QString archivePath;
+    QString memberName;
+    return splitPath(path, archivePath, memberName);
+}
+
+bool ArchiveReader::splitPath(const QString &path, QString &archivePath, QString &memberName)
+{
+    // Whether each path that looked like an archive was one, so browsing its members only checks the disk once
+    static QMutex archivePathsMutex;
+    static QCache<QString, bool> archivePaths(256);
+
+    // Members are addressed as if the archive was a folder, e.g. /comics/issue.cbz/page01.jpg.
+    // Paths without an archive suffix followed by a slash, which is nearly all of them, never touch the disk.
+    for (const auto &suffix : archiveSuffixes)
+    {
+        const QString pattern = '.' + suffix + '/';
+        int index = path.indexOf(pattern, 0, Qt::CaseInsensitive);
+        while (index != -1)
+        {
+            const int archivePathLength = index + pattern.length() - 1;
+            const QString candidatePath = path.left(archivePathLength);
+
+            bool isFile;
+            {
+                QMutexLocker locker(&archivePathsMutex);
+                const bool *cachedIsFile = archivePaths.object(candidatePath);
+                isFile = cachedIsFile ? *cachedIsFile : QFileInfo(candidatePath).isFile();
+                if (!cachedIsFile)
+                    archivePaths.insert(candidatePath, new bool(isFile));
+            }
+
+            if (isFile)
+            {
+                archivePath = candidatePath;
+                memberName = path.mid(archivePathLength + 1);
+                return !memberName.isEmpty();
+            }
+            index = path.indexOf(pattern, index + 1, Qt::CaseInsensitive);
+        }
+    }
+    return false;
+}
+
+QStringList ArchiveReader::getMemberNames(const QString &archivePath)
+{
+    const Directory directory = getDirectory(archivePath);
+
+    QStringList memberNames;
+    memberNames.reserve(directory.members.size());
+    for (const auto &member : directory.members)
+        memberNames.append(member.name);
+
+    return memberNames;
+}
+
+QByteArray ArchiveReader::readMember(const QString &archivePath, const QString &memberName)
+{
+    const Directory directory = getDirectory(archivePath);
+    auto memberIndex = directory.memberIndexes.constFind(memberName);
+    if (memberIndex == directory.memberIndexes.constEnd())
+        return QByteArray();
+
+    const Member &member = directory.members.at(*memberIndex);
+
+    QFile file(archivePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+
+    qint64 dataOffset = member.offset;
+    if (zipSuffixes.contains(QFileInfo(archivePath).suffix().toLower()))
+    {
+        // The local header's name and extra field can differ in length from the central directory's
+        if (!file.seek(member.offset))
+            return QByteArray();
+
+        const QByteArray localHeader = file.read(30);
+        if (localHeader.size() != 30 || readUInt32(localHeader.constData()) != 0x04034b50)
+            return QByteArray();
+
+        dataOffset += 30 + readUInt16(localHeader.constData() + 26) + readUInt16(localHeader.constData() + 28);
+    }
+
+    if (!file.seek(dataOffset))
+        return QByteArray();
+
+    const QByteArray data = file.read(member.compressedSize);
+    if (data.size() != member.compressedSize)
+        return QByteArray();
+
+    if (member.method == 0)
+        return data;
+
+#ifdef ARCHIVE_LOADED
+    // Deflate, the size is known up front so it is inflated in one go
+    QByteArray inflatedData(static_cast<int>(member.size), Qt::Uninitialized);
+
+    z_stream stream = {};
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(inflatedData.data());
+    stream.avail_out = static_cast<uInt>(inflatedData.size());
+
+    // Negative window bits mean raw deflate without a zlib header, which is what zip uses
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+        return QByteArray();
+
+    const int result = inflate(&stream, Z_FINISH);
+    inflateEnd(&stream);
+
+    if (result != Z_STREAM_END)
+        return QByteArray();
+
+    inflatedData.truncate(static_cast<int>(stream.total_out));
+    return inflatedData;
+#else
+    return QByteArray();
+#endif
+}
+
+QStringList ArchiveReader::getNameFilters()
+{
+    QStringList nameFilters;
+    for (const auto &suffix : archiveSuffixes)
+        nameFilters << "*." + suffix;
+    return nameFilters;
+}
+
+ArchiveReader::Directory ArchiveReader::getDirectory(const QString &archivePath)
+{
+    // Directories are read once and shared by every window and worker thread. The least recently
+    // used ones are dropped once the cached archives hold too many members between them.
+    static QMutex directoriesMutex;
+    static QCache<QString, Directory> directories(maxCachedMembers);
+
+    const QFileInfo fileInfo(archivePath);
+
+    QMutexLocker locker(&directoriesMutex);
+    const Directory *directory = directories.object(archivePath);
+    if (directory && directory->lastModified == fileInfo.lastModified() && directory->size == fileInfo.size())
+        return *directory;
+
+    Directory newDirectory;
+    QFile file(archivePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return newDirectory;
+
+    newDirectory.lastModified = fileInfo.lastModified();
+    newDirectory.size = fileInfo.size();
+    newDirectory.members = zipSuffixes.contains(fileInfo.suffix().toLower()) ? readZipDirectory(file) : readTarDirectory(file);
+    for (int i = 0; i < newDirectory.members.size(); i++)
+        newDirectory.memberIndexes.insert(newDirectory.members.at(i).name, i);
+
+    directories.insert(archivePath, new Directory(newDirectory), newDirectory.members.size() + 1);
+    return newDirectory;
+}
+
+QVector<ArchiveReader::Member> ArchiveReader::readZipDirectory(QFile &file)
+{
+    QVector<Member> members;
+
+    // The end of central directory record is in the last 22 bytes, plus up to 64 KiB of comment
+    const qint64 fileSize = file.size();
+    const qint64 tailSize = qMin<qint64>(fileSize, 22 + 65535);
+    if (tailSize < 22 || !file.seek(fileSize - tailSize))
+        return members;
+
+    const QByteArray tail = file.read(tailSize);
+    int endRecordIndex = -1;
+    for (int i = tail.size() - 22; i >= 0; i--)
+    {
+        if (readUInt32(tail.constData() + i) == 0x06054b50)
+        {
+            endRecordIndex = i;
+            break;
+        }
+    }
+    if (endRecordIndex == -1)
+        return members;
+
+    const char *endRecord = tail.constData() + endRecordIndex;
+    quint64 directorySize = readUInt32(endRecord + 12);
+    quint64 directoryOffset = readUInt32(endRecord + 16);
+
+    // Zip64 archives keep the real values in another record that a locator right before this one points to
+    if ((directorySize == 0xFFFFFFFF || directoryOffset == 0xFFFFFFFF) && endRecordIndex >= 20 &&
+        readUInt32(endRecord - 20) == 0x07064b50)
+    {
+        if (file.seek(static_cast<qint64>(readUInt64(endRecord - 20 + 8))))
+        {
+            const QByteArray zip64EndRecord = file.read(56);
+            if (zip64EndRecord.size() == 56 && readUInt32(zip64EndRecord.constData()) == 0x06064b50)
+            {
+                directorySize = readUInt64(zip64EndRecord.constData() + 40);
+                directoryOffset = readUInt64(zip64EndRecord.constData() + 48);
+            }
+        }
+    }
+
+    if (directoryOffset + directorySize > static_cast<quint64>(fileSize) || directorySize > INT_MAX || !file.seek(static_cast<qint64>(directoryOffset)))
+        return members;
+
+    const QByteArray directory = file.read(static_cast<qint64>(directorySize));
+    const char *data = directory.constData();
+    int position = 0;
+    while (position + 46 <= directory.size() && readUInt32(data + position) == 0x02014b50)
+    {
+        const quint16 flags = readUInt16(data + position + 8);
+        const quint16 method = readUInt16(data + position + 10);
+        quint64 compressedSize = readUInt32(data + position + 20);
+        quint64 size = readUInt32(data + position + 24);
+        const int nameLength = readUInt16(data + position + 28);
+        const int extraLength = readUInt16(data + position + 30);
+        const int commentLength = readUInt16(data + position + 32);
+        quint64 offset = readUInt32(data + position + 42);
+
+        const int nameIndex = position + 46;
+        if (nameIndex + nameLength + extraLength > directory.size())
+            break;
+
+        const QByteArray nameBytes = directory.mid(nameIndex, nameLength);
+
+        // The zip64 extra field only holds the values that didn't fit, in this order
+        int extraIndex = nameIndex + nameLength;
+        const int extraEnd = extraIndex + extraLength;
+        while (extraIndex + 4 <= extraEnd)
+        {
+            const quint16 headerId = readUInt16(data + extraIndex);
+            const int dataSize = readUInt16(data + extraIndex + 2);
+            if (headerId == 0x0001)
+            {
+                int valueIndex = extraIndex + 4;
+                const int valueEnd = qMin(valueIndex + dataSize, extraEnd);
+                if (size == 0xFFFFFFFF && valueIndex + 8 <= valueEnd)
+                {
+                    size = readUInt64(data + valueIndex);
+                    valueIndex += 8;
+                }
+                if (compressedSize == 0xFFFFFFFF && valueIndex + 8 <= valueEnd)
+                {
+                    compressedSize = readUInt64(data + valueIndex);
+                    valueIndex += 8;
+                }
+                if (offset == 0xFFFFFFFF && valueIndex + 8 <= valueEnd)
+                    offset = readUInt64(data + valueIndex);
+            }
+            extraIndex += 4 + dataSize;
+        }
+
+        position = nameIndex + nameLength + extraLength + commentLength;
+
+        // Skip folders, encrypted members and anything that is neither stored nor deflated
+        if (nameBytes.endsWith('/') || (flags & 0x1) || size > INT_MAX)
+            continue;
+#ifdef ARCHIVE_LOADED
+        if (method != 0 && method != 8)
+            continue;
+#else
+        if (method != 0)
+            continue;
+#endif
+
+        QString name = (flags & 0x800) ? QString::fromUtf8(nameBytes) : QString::fromLocal8Bit(nameBytes);
+        name.replace('\\', '/');
+        while (name.startsWith('/'))
+            name.remove(0, 1);
+
+        members.append({name, static_cast<qint64>(offset), static_cast<qint64>(compressedSize), static_cast<qint64>(size), method});
+    }
+
+    return members;
+}
+
+QVector<ArchiveReader::Member> ArchiveReader::readTarDirectory(QFile &file)
+{
+    QVector<Member> members;
+
+    const qint64 fileSize = file.size();
+    qint64 position = 0;
+    QString longName;
+    while (position + 512 <= fileSize && file.seek(position))
+    {
+        const QByteArray header = file.read(512);
+        if (header.size() != 512 || header.count('\0') == 512)
+            break;
+
+        const qint64 size = readTarNumber(header.mid(124, 12));
+        const char type = header.at(156);
+        const qint64 dataOffset = position + 512;
+        position = dataOffset + ((size + 511) / 512) * 512;
+
+        // GNU and pax archives put long names in an entry of their own before the file
+        if (type == 'L')
+        {
+            longName = readTarString(file.read(size));
+            continue;
+        }
+        if (type == 'x')
+        {
+            const QByteArray records = file.read(size);
+            const int pathIndex = records.indexOf(" path=");
+            if (pathIndex != -1)
+            {
+                const int valueIndex = pathIndex + 6;
+                longName = QString::fromUtf8(records.mid(valueIndex, records.indexOf('\n', valueIndex) - valueIndex));
+            }
+            continue;
+        }
+
+        // Only regular files are interesting
+        if (type != '0' && type != '\0' && type != '7')
+        {
+            longName.clear();
+            continue;
+        }
+
+        QString name = longName;
+        longName.clear();
+        if (name.isEmpty())
+        {
+            name = readTarString(header.mid(0, 100));
+            const QString prefix = header.mid(257, 5) == "ustar" ? readTarString(header.mid(345, 155)) : QString();
+            if (!prefix.isEmpty())
+                name = prefix + '/' + name;
+        }
+
+        while (name.startsWith('/'))
+            name.remove(0, 1);
+        if (name.startsWith("./"))
+            name.remove(0, 2);
+
+        if (name.isEmpty() || name.endsWith('/') || size > INT_MAX)
+            continue;
+
+        members.append({name, dataOffset, size, size, 0});
+    }
+
+    return members;
+}
@@ -0,0 +1,54 @@
+#ifndef ARCHIVEREADER_H
+#define ARCHIVEREADER_H
+
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QDateTime>
+
+class QFile;
+
+class ArchiveReader
+{
+public:
+    struct Member
+    {
+        QString name;
+        // Local header for zip members, start of the data for tar members
+        qint64 offset;
+        qint64 compressedSize;
+        qint64 size;
+        quint16 method;
+    };
+
+    static bool isArchive(const QString &filePath);
+
+    static bool isArchiveMember(const QString &path);
+
+    static bool splitPath(const QString &path, QString &archivePath, QString &memberName);
+
+    static QStringList getMemberNames(const QString &archivePath);
+
+    static QByteArray readMember(const QString &archivePath, const QString &memberName);
+
+    static QStringList getNameFilters();
+
+protected:
+    struct Directory
+    {
+        QDateTime lastModified;
+        qint64 size = -1;
+        QVector<Member> members;
+        QHash<QString, int> memberIndexes;
+    };
+
+    static Directory getDirectory(const QString &archivePath);
+
+    static QVector<Member> readZipDirectory(QFile &file);
+
+    static QVector<Member> readTarDirectory(QFile &file);
+
+    static const int maxCachedMembers = 100000;
+};
+
+#endif // ARCHIVEREADER_H
@@ -0,0 +1,150 @@
+#include "batchconverter.h"
+#include "qvimagecore.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
+#include <QImageWriter>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentMap>
+#include <functional>
+
+int BatchConverter::run(const QStringList &files, const Options &options)
+{
+    if (!QDir().mkpath(options.outputPath))
+    {
+        qCritical().noquote() << QObject::tr("Couldn't create output folder %1").arg(options.outputPath);
+        return 1;
+    }
+
+    QElapsedTimer conversionTimer;
+    conversionTimer.start();
+
+    // Two inputs that would end up with the same output are both left alone instead of overwriting each other
+    const QStringList outputFileNames = getOutputFileNames(files, options);
+    QHash<QString, int> outputCounts;
+    for (const auto &outputFileName : outputFileNames)
+        outputCounts[outputFileName.toCaseFolded()]++;
+
+    QVector<QPair<QString, QString>> conversions;
+    QStringList errors;
+    for (int i = 0; i < files.size(); i++)
+    {
+        if (outputCounts.value(outputFileNames.at(i).toCaseFolded()) > 1)
+            errors.append(QObject::tr("Skipped %1: another input would also be written to %2").arg(files.at(i), outputFileNames.at(i)));
+        else
+            conversions.append({files.at(i), outputFileNames.at(i)});
+    }
+
+    // Every thread claims the next few files as soon as it's done with its own, so slow images don't hold up
+    // the rest, and only one decoded image per thread is ever in memory
+    std::function<QString(const QPair<QString, QString>&)> convert = [options](const QPair<QString, QString> &conversion) {
+        return convertFile(conversion.first, conversion.second, options);
+    };
+    errors += QtConcurrent::blockingMapped<QStringList>(conversions, convert);
+
+    int failedCount = 0;
+    for (const auto &error : errors)
+    {
+        if (error.isEmpty())
+            continue;
+
+        qWarning().noquote() << error;
+        failedCount++;
+    }
+
+    const double seconds = qMax<qint64>(1, conversionTimer.elapsed())/1000.0;
+    qInfo().noquote() << QObject::tr("Converted %1 of %2 images in %3 s (%4 images/s on %5 threads)")
+                         .arg(files.size() - failedCount).arg(files.size())
+                         .arg(seconds, 0, 'f', 1).arg((files.size() - failedCount)/seconds, 0, 'f', 1)
+                         .arg(QThreadPool::globalInstance()->maxThreadCount());
+
+    return failedCount > 0 ? 1 : 0;
+}
+
+QString BatchConverter::convertFile(const QString &fileName, const QString &outputFileName, const Options &options)
+{
+    // Color profiles are written out with the image instead of being converted for the screen
+    const QVImageCore::ReadData readData = QVImageCore::readFile(fileName, qMax(options.size.width(), options.size.height()), false);
+    if (readData.image.isNull())
+        return QObject::tr("Couldn't read %1: %2").arg(fileName, readData.errorString);
+
+    QImage image = readData.image;
+    if (options.size.isValid() && (image.width() > options.size.width() || image.height() > options.size.height()))
+    {
+        image = QVImageCore::scaleImage(image, options.size, QVImageCore::ScaleMode::normal, options.rotation);
+    }
+    else if (options.rotation)
+    {
+        QTransform transform;
+        transform.rotate(options.rotation);
+        image = image.transformed(transform);
+    }
+
+    QDir().mkpath(QFileInfo(outputFileName).absolutePath());
+    QImageWriter imageWriter(outputFileName, options.format);
+    if (options.quality >= 0)
+        imageWriter.setQuality(options.quality);
+
+    if (!imageWriter.write(image))
+        return QObject::tr("Couldn't write %1: %2").arg(outputFileName, imageWriter.errorString());
+
+    return QString();
+}
+
+QStringList BatchConverter::getOutputFileNames(const QStringList &files, const Options &options)
+{
+    const QList<QByteArray> supportedFormats = QImageWriter::supportedImageFormats();
+    const QDir outputDir(options.outputPath);
+
+    QStringList outputFileNames;
+    QStringList relativeFileNames;
+    QSet<QString> seenFileNames;
+    bool hasDuplicates = false;
+    QString commonPath;
+    for (const auto &fileName : files)
+    {
+        const QFileInfo fileInfo(fileName);
+
+        QString suffix = options.format.isEmpty() ? fileInfo.suffix() : QString::fromLatin1(options.format);
+        if (!supportedFormats.contains(suffix.toLower().toLatin1()))
+            suffix = "png";
+
+        const QString outputName = fileInfo.completeBaseName() + '.' + suffix;
+        outputFileNames.append(outputDir.filePath(outputName));
+        relativeFileNames.append(QDir(fileInfo.absolutePath()).filePath(outputName));
+
+        if (seenFileNames.contains(outputName.toCaseFolded()))
+            hasDuplicates = true;
+        seenFileNames.insert(outputName.toCaseFolded());
+
+        // The deepest folder all of the inputs are in
+        const QString path = fileInfo.absolutePath();
+        if (commonPath.isNull())
+            commonPath = path;
+        while (path != commonPath && !path.startsWith(commonPath.endsWith('/') ? commonPath : commonPath + '/'))
+        {
+            const QString parentPath = QFileInfo(commonPath).absolutePath();
+            if (parentPath == commonPath)
+                break;
+            commonPath = parentPath;
+        }
+    }
+
+    // Usually everything goes straight into the output folder, but when names clash the
+    // inputs' folders are recreated under it, relative to the folder they have in common
+    if (!hasDuplicates)
+        return outputFileNames;
+
+    // Inputs on different drives share no folder, those keep their clashing names and are skipped
+    const QDir commonDir(commonPath);
+    for (int i = 0; i < relativeFileNames.size(); i++)
+    {
+        const QString relativeFileName = commonDir.relativeFilePath(relativeFileNames.at(i));
+        if (!QDir::isAbsolutePath(relativeFileName) && !relativeFileName.startsWith(".."))
+            outputFileNames[i] = outputDir.filePath(relativeFileName);
+    }
+
+    return outputFileNames;
+}
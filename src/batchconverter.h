@@ -0,0 +1,27 @@
+#ifndef BATCHCONVERTER_H
+#define BATCHCONVERTER_H
+
+#include <QSize>
+#include <QStringList>
+
+class BatchConverter
+{
+public:
+    struct Options
+    {
+        QString outputPath;
+        QSize size;
+        int rotation = 0;
+        QByteArray format;
+        int quality = -1;
+    };
+
+    static int run(const QStringList &files, const Options &options);
+
+protected:
+    static QString convertFile(const QString &fileName, const QString &outputFileName, const Options &options);
+
+    static QStringList getOutputFileNames(const QStringList &files, const Options &options);
+};
+
+#endif // BATCHCONVERTER_H
@@ -0,0 +1,77 @@
+#include "directorywalker.h"
+
+#include <QThread>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+
+DirectoryWalker::DirectoryWalker(const QString &rootPath, const QStringList &nameFilters, bool fetchMetadata,
+                                 const std::shared_ptr<std::atomic<bool>> &isCancelled, QObject *parent) : QObject(parent)
+{
+    this->rootPath = rootPath;
+    this->nameFilters = nameFilters;
+    this->fetchMetadata = fetchMetadata;
+    this->isCancelled = isCancelled;
+
+    qRegisterMetaType<QFileInfoList>("QFileInfoList");
+}
+
+void DirectoryWalker::start()
+{
+    // Big trees take a while, so walk them on a thread of their own instead of tying up one that decodes
+    auto *thread = new QThread();
+    moveToThread(thread);
+
+    connect(thread, &QThread::started, this, &DirectoryWalker::walk);
+    connect(this, &DirectoryWalker::finished, thread, &QThread::quit);
+    connect(thread, &QThread::finished, this, &QObject::deleteLater);
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+
+    thread->start(QThread::LowPriority);
+}
+
+void DirectoryWalker::walk()
+{
+    QFileInfoList batch;
+    QElapsedTimer batchTimer;
+    batchTimer.start();
+
+    // Files directly inside the root are listed by whoever started the walk, so only subfolders are walked here
+    const QFileInfoList subfolders = QDir(rootPath).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    for (const auto &subfolder : subfolders)
+    {
+        QDirIterator iterator(subfolder.absoluteFilePath(), nameFilters, QDir::Files, QDirIterator::Subdirectories);
+        while (iterator.hasNext())
+        {
+            if (*isCancelled)
+            {
+                emit finished();
+                return;
+            }
+
+            iterator.next();
+            QFileInfo fileInfo = iterator.fileInfo();
+
+            // Stat here so sorting by time or size doesn't have to on the GUI thread
+            if (fetchMetadata)
+            {
+                fileInfo.size();
+                fileInfo.lastModified();
+            }
+
+            batch.append(fileInfo);
+
+            if (batch.size() >= 500 || batchTimer.elapsed() >= 100)
+            {
+                emit entriesFound(batch);
+                batch.clear();
+                batchTimer.restart();
+            }
+        }
+    }
+
+    if (!batch.isEmpty() && !*isCancelled)
+        emit entriesFound(batch);
+
+    emit finished();
+}
@@ -0,0 +1,34 @@
+#ifndef DIRECTORYWALKER_H
+#define DIRECTORYWALKER_H
+
+#include <QObject>
+#include <QFileInfo>
+#include <atomic>
+#include <memory>
+
+class DirectoryWalker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DirectoryWalker(const QString &rootPath, const QStringList &nameFilters, bool fetchMetadata,
+                             const std::shared_ptr<std::atomic<bool>> &isCancelled, QObject *parent = nullptr);
+
+    void start();
+
+signals:
+    void entriesFound(const QFileInfoList &entries);
+
+    void finished();
+
+protected:
+    void walk();
+
+private:
+    QString rootPath;
+    QStringList nameFilters;
+    bool fetchMetadata;
+
+    std::shared_ptr<std::atomic<bool>> isCancelled;
+};
+
+#endif // DIRECTORYWALKER_H
@@ -0,0 +1,188 @@
+#include "downloadmanager.h"
+#include "qvapplication.h"
+
+#include <QCoreApplication>
+#include <QNetworkDiskCache>
+#include <QStandardPaths>
+#include <QFileInfo>
+#include <QDir>
+
+DownloadManager::DownloadManager(QObject *parent) : QObject(parent),
+    downloadDir(QDir::tempPath() + '/' + QCoreApplication::applicationName() + "-downloads-XXXXXX")
+{
+    downloadCount = 0;
+
+    // Opening the same URL again is answered from disk when the server allows it
+    auto *diskCache = new QNetworkDiskCache(this);
+    diskCache->setCacheDirectory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/downloads");
+    diskCache->setMaximumCacheSize(100*1024*1024);
+    networkAccessManager.setCache(diskCache);
+}
+
+void DownloadManager::download(const QUrl &url)
+{
+    // Whoever asked for the same URL gets the result of the transfer that is already queued or running
+    waiterCounts[url]++;
+    if (activeDownloads.contains(url) || queuedUrls.contains(url))
+        return;
+
+    queuedUrls.enqueue(url);
+    startNextDownloads();
+}
+
+void DownloadManager::cancel(const QUrl &url)
+{
+    auto waiterCount = waiterCounts.find(url);
+    if (waiterCount == waiterCounts.end())
+        return;
+
+    if (--waiterCount.value() > 0)
+        return;
+
+    waiterCounts.erase(waiterCount);
+
+    if (queuedUrls.removeAll(url) > 0)
+    {
+        emit downloadFailed(url, tr("Download canceled"));
+        return;
+    }
+
+    auto activeDownload = activeDownloads.constFind(url);
+    if (activeDownload != activeDownloads.constEnd())
+        activeDownload->reply->abort();
+}
+
+void DownloadManager::startNextDownloads()
+{
+    while (activeDownloads.size() < maxActiveDownloads && !queuedUrls.isEmpty())
+    {
+        const QUrl url = queuedUrls.dequeue();
+
+        // The file only gets its name once the contents show what kind of image it is
+        auto *file = new QFile(downloadDir.filePath(QString::number(++downloadCount) + ".part"), this);
+        if (!downloadDir.isValid() || !file->open(QIODevice::WriteOnly))
+        {
+            file->deleteLater();
+            statistics.failedCount++;
+            waiterCounts.remove(url);
+            emit downloadFailed(url, tr("Could not create a temporary file"));
+            continue;
+        }
+
+        QNetworkRequest request(url);
+        request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+        auto *reply = networkAccessManager.get(request);
+
+        ActiveDownload activeDownload;
+        activeDownload.reply = reply;
+        activeDownload.file = file;
+        activeDownload.timer.start();
+        activeDownloads.insert(url, activeDownload);
+
+        connect(reply, &QNetworkReply::readyRead, this, [reply, file]{
+            file->write(reply->readAll());
+        });
+
+        connect(reply, &QNetworkReply::downloadProgress, this, [url, this](qint64 bytesReceived, qint64 bytesTotal){
+            emit downloadProgress(url, bytesReceived, bytesTotal);
+        });
+
+        connect(reply, &QNetworkReply::finished, this, [url, this]{
+            replyFinished(url);
+        });
+    }
+}
+
+void DownloadManager::replyFinished(const QUrl &url)
+{
+    const ActiveDownload activeDownload = activeDownloads.take(url);
+    waiterCounts.remove(url);
+    auto *reply = activeDownload.reply;
+    auto *file = activeDownload.file;
+    reply->deleteLater();
+
+    file->deleteLater();
+
+    if (reply->error())
+    {
+        statistics.failedCount++;
+        file->remove();
+        emit downloadFailed(url, tr("Error ") + QString::number(reply->error()) + ": " + reply->errorString());
+    }
+    else
+    {
+        file->write(reply->readAll());
+        file->close();
+
+        statistics.finishedCount++;
+        statistics.bytesReceived += file->size();
+        statistics.transferTime += activeDownload.timer.elapsed();
+        if (reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool())
+            statistics.cacheHitCount++;
+
+        // The original bytes are kept under a suffix the viewer recognises, so they are decoded exactly once when opened
+        QString baseName = QFileInfo(url.path()).completeBaseName();
+        if (baseName.isEmpty())
+            baseName = "download";
+        const QString suffix = getSuffix(file, reply);
+
+        QString fileName = downloadDir.filePath(baseName + '.' + suffix);
+        for (int i = 2; QFile::exists(fileName); i++)
+            fileName = downloadDir.filePath(QString("%1 (%2).%3").arg(baseName).arg(i).arg(suffix));
+
+        // The download number is unique, so that name is the fallback when the descriptive one can't be used
+        const QString fallbackFileName = downloadDir.filePath(QFileInfo(file->fileName()).completeBaseName() + '.' + suffix);
+        if (!file->rename(fileName) && !file->rename(fallbackFileName))
+            qWarning().noquote() << QString("Could not rename %1: %2").arg(file->fileName(), file->errorString());
+
+        emit downloadFinished(url, file->fileName());
+    }
+
+    startNextDownloads();
+
+    if (activeDownloads.isEmpty() && queuedUrls.isEmpty())
+        reportStatistics();
+}
+
+QString DownloadManager::getSuffix(QFile *file, const QNetworkReply *reply)
+{
+    const QStringList &filterList = qvApp->getFilterList();
+    auto isSupported = [&filterList](const QString &suffix) {
+        return !suffix.isEmpty() && filterList.contains("*." + suffix.toLower());
+    };
+
+    // What the bytes say comes first, since URLs like image.php?id=3 or extensionless CDN paths say nothing
+    QByteArray format;
+    if (file->open(QIODevice::ReadOnly))
+    {
+        format = QVImageCore::detectFormat(file);
+        file->close();
+    }
+    if (format == "apng")
+        format = "png";
+    if (isSupported(format))
+        return format;
+
+    // Then what the server says it sent, like image/jpeg or image/svg+xml
+    const QString contentType = reply->header(QNetworkRequest::ContentTypeHeader).toString();
+    if (contentType.startsWith("image/"))
+    {
+        const QString subtype = contentType.mid(6).section(';', 0, 0).section('+', 0, 0).trimmed();
+        if (isSupported(subtype))
+            return subtype;
+    }
+
+    const QString urlSuffix = QFileInfo(reply->url().path()).suffix();
+    if (isSupported(urlSuffix))
+        return urlSuffix.toLower();
+
+    return "png";
+}
+
+void DownloadManager::reportStatistics()
+{
+    const qint64 kibPerSecond = statistics.transferTime > 0 ? (statistics.bytesReceived/1024)*1000/statistics.transferTime : 0;
+    qInfo().noquote() << QString("Downloads: %1 finished (%2 from cache), %3 failed, %4 KiB in %5 ms, %6 KiB/s")
+                         .arg(statistics.finishedCount).arg(statistics.cacheHitCount).arg(statistics.failedCount)
+                         .arg(statistics.bytesReceived/1024).arg(statistics.transferTime).arg(kibPerSecond);
+}
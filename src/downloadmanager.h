@@ -0,0 +1,76 @@
+#ifndef DOWNLOADMANAGER_H
+#define DOWNLOADMANAGER_H
+
+#include <QObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QQueue>
+#include <QHash>
+#include <QUrl>
+
+class DownloadManager : public QObject
+{
+    Q_OBJECT
+public:
+    struct Statistics
+    {
+        int finishedCount = 0;
+        int failedCount = 0;
+        int cacheHitCount = 0;
+        qint64 bytesReceived = 0;
+        qint64 transferTime = 0;
+    };
+
+    explicit DownloadManager(QObject *parent = nullptr);
+
+    void download(const QUrl &url);
+
+    void cancel(const QUrl &url);
+
+    const Statistics &getStatistics() const { return statistics; }
+
+signals:
+    void downloadProgress(const QUrl &url, qint64 bytesReceived, qint64 bytesTotal);
+
+    void downloadFinished(const QUrl &url, const QString &filePath);
+
+    void downloadFailed(const QUrl &url, const QString &errorString);
+
+protected:
+    void startNextDownloads();
+
+    void replyFinished(const QUrl &url);
+
+    void reportStatistics();
+
+    static QString getSuffix(QFile *file, const QNetworkReply *reply);
+
+private:
+    struct ActiveDownload
+    {
+        QNetworkReply *reply;
+        QFile *file;
+        QElapsedTimer timer;
+    };
+
+    QNetworkAccessManager networkAccessManager;
+
+    // Downloads get a folder of their own, so browsing next to one only finds the other downloads
+    QTemporaryDir downloadDir;
+    int downloadCount;
+
+    QQueue<QUrl> queuedUrls;
+    QHash<QUrl, ActiveDownload> activeDownloads;
+
+    // How many requests are waiting on each URL, since windows share a transfer and only the last one to give up stops it
+    QHash<QUrl, int> waiterCounts;
+
+    Statistics statistics;
+
+    const int maxActiveDownloads = 4;
+};
+
+#endif // DOWNLOADMANAGER_H
@@ -0,0 +1,108 @@
+#include "filelistreader.h"
+
+#include <QThread>
+#include <QFile>
+
+FileListReader::FileListReader(FILE *stream, QObject *parent) : QObject(parent)
+{
+    this->stream = stream;
+    sendTimer = nullptr;
+    isReadFinished = false;
+    isFirstBatchSent = false;
+}
+
+void FileListReader::start()
+{
+    // Not a child, so it stays behind in this thread when the reader moves
+    sendTimer = new QTimer();
+    sendTimer->setSingleShot(true);
+    connect(sendTimer, &QTimer::timeout, sendTimer, [this]{
+        sendPendingFiles();
+    });
+
+    // Reading blocks until the other end closes the stream, so it gets its own thread.
+    // The thread is not parented to anything because it may outlive the application.
+    auto *thread = new QThread();
+    moveToThread(thread);
+
+    connect(thread, &QThread::started, this, &FileListReader::read);
+    connect(this, &FileListReader::finished, thread, &QThread::quit);
+    connect(thread, &QThread::finished, this, &QObject::deleteLater);
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+
+    thread->start();
+}
+
+void FileListReader::read()
+{
+    QByteArray entry;
+    // Once a NUL shows up the list came from something like find -print0, so newlines are part of names
+    bool isNullSeparated = false;
+
+    int character;
+    while ((character = std::fgetc(stream)) != EOF)
+    {
+        if (character == '\0')
+            isNullSeparated = true;
+
+        if (character != '\0' && (character != '\n' || isNullSeparated))
+        {
+            entry.append(static_cast<char>(character));
+            continue;
+        }
+
+        if (entry.endsWith('\r'))
+            entry.chop(1);
+
+        if (!entry.isEmpty())
+            addFile(QFile::decodeName(entry));
+        entry.clear();
+    }
+
+    if (entry.endsWith('\r'))
+        entry.chop(1);
+
+    if (!entry.isEmpty())
+        addFile(QFile::decodeName(entry));
+
+    QMutexLocker locker(&pendingMutex);
+    isReadFinished = true;
+    QMetaObject::invokeMethod(sendTimer, "start", Qt::QueuedConnection, Q_ARG(int, 0));
+}
+
+void FileListReader::addFile(const QString &file)
+{
+    QMutexLocker locker(&pendingMutex);
+    pendingFiles.append(file);
+
+    // The first file is shown as soon as it arrives, after that files are handed over in batches
+    // to keep the navigation index cheap to update, at most a tenth of a second after they came in
+    if (pendingFiles.size() == 1)
+        QMetaObject::invokeMethod(sendTimer, "start", Qt::QueuedConnection, Q_ARG(int, isFirstBatchSent ? 100 : 0));
+    else if (pendingFiles.size() == 1000)
+        QMetaObject::invokeMethod(sendTimer, "start", Qt::QueuedConnection, Q_ARG(int, 0));
+}
+
+void FileListReader::sendPendingFiles()
+{
+    QStringList files;
+    bool isFirstBatch;
+    bool isDone;
+    {
+        QMutexLocker locker(&pendingMutex);
+        files.swap(pendingFiles);
+        isFirstBatch = !isFirstBatchSent;
+        isFirstBatchSent = true;
+        isDone = isReadFinished && !sendTimer->isActive();
+    }
+
+    // Whoever is waiting for the first files still hears about it when the list is empty
+    if (!files.isEmpty() || isFirstBatch)
+        emit filesRead(files);
+
+    if (isDone)
+    {
+        sendTimer->deleteLater();
+        emit finished();
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef FILELISTREADER_H
+#define FILELISTREADER_H
+
+#include <QObject>
+#include <QMutex>
+#include <QStringList>
+#include <QTimer>
+#include <cstdio>
+
+class FileListReader : public QObject
+{
+    Q_OBJECT
+public:
+    explicit FileListReader(FILE *stream, QObject *parent = nullptr);
+
+    void start();
+
+signals:
+    void filesRead(const QStringList &files);
+
+    void finished();
+
+protected:
+    void read();
+
+    void addFile(const QString &file);
+
+    void sendPendingFiles();
+
+private:
+    FILE *stream;
+
+    // Lives in the thread that called start(), which is where the files are handed over,
+    // since the reading thread is blocked whenever nothing arrives
+    QTimer *sendTimer;
+
+    QMutex pendingMutex;
+    QStringList pendingFiles;
+    bool isReadFinished;
+    bool isFirstBatchSent;
+};
+
+#endif // FILELISTREADER_H
@@ -0,0 +1,563 @@
+#include "imagemanager.h"
+#include "qvapplication.h"
+
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QThreadPool>
+#include <QFile>
+#include <QTimer>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QtMath>
+
+ImageManager::ImageManager(QObject *parent) : QObject(parent)
+{
+    budgetLimit = 524288;
+    cacheLimit = budgetLimit;
+    cacheSize = 0;
+    encodedCacheSize = 0;
+    useCounter = 0;
+
+    averageDecodeTime = 0;
+    averageCost = 0;
+    decodeCount = 0;
+    averageEncodedCost = 0;
+    averageEncodedReadTime = 0;
+    encodedReadCount = 0;
+
+    encodedReadPool.setMaxThreadCount(1);
+
+    memoryPressure = MemoryPressure::none;
+
+    isColorManaged = true;
+    isDeepImageKept = true;
+
+#ifdef Q_OS_LINUX
+    // Give memory back before the system has to go looking for something to kill
+    auto *memoryPressureTimer = new QTimer(this);
+    memoryPressureTimer->setInterval(2000);
+    connect(memoryPressureTimer, &QTimer::timeout, this, &ImageManager::checkMemoryPressure);
+    memoryPressureTimer->start();
+#endif
+
+    // Vectors are rendered at the size of the largest screen, which is the same for every window
+    largestDimension = 0;
+    const auto screenList = QGuiApplication::screens();
+    for (auto const &screen : screenList)
+    {
+        int largerDimension = qMax(screen->size().width(), screen->size().height());
+
+        if (largerDimension > largestDimension)
+            largestDimension = largerDimension;
+    }
+
+    // Connect to settings signal
+    connect(&qvApp->getSettingsManager(), &SettingsManager::settingsUpdated, this, &ImageManager::settingsUpdated);
+    settingsUpdated();
+}
+
+bool ImageManager::findCachedImage(const QFileInfo &fileInfo, QVImageCore::ReadData &readData)
+{
+    const QString filePath = fileInfo.absoluteFilePath();
+
+    auto it = cache.find(filePath);
+    if (it == cache.end() || it->image.isNull())
+        return false;
+
+    // The file changed since it was cached, so the entry is useless
+    if (it->fileSize != fileInfo.size())
+    {
+        cacheSize -= it->cost;
+        cache.erase(it);
+        return false;
+    }
+
+    it->lastUsed = ++useCounter;
+
+    readData.image = it->image;
+    readData.deepImage = it->deepImage;
+    readData.fileInfo = fileInfo;
+    readData.size = it->imageSize;
+    readData.frameCount = it->frameCount;
+    readData.isAnimated = it->isAnimated;
+    return true;
+}
+
+QFuture<QVImageCore::ReadData> ImageManager::requestRead(const QString &filePath, qint64 maxCost)
+{
+    // Share a decode that is already in flight, whichever window started it
+    auto pendingRead = pendingReads.constFind(filePath);
+    if (pendingRead != pendingReads.constEnd() && (maxCost >= 0 || !sizeLimitedReads.contains(filePath)))
+        return *pendingRead;
+
+    // Files that were already read into memory for a far preload only have to be decoded now
+    QByteArray encodedData;
+    auto encodedEntry = encodedCache.constFind(filePath);
+    if (encodedEntry != encodedCache.constEnd() && encodedEntry->fileSize == QFileInfo(filePath).size())
+        encodedData = encodedEntry->data;
+
+    auto future = QtConcurrent::run(&QVImageCore::readFile, filePath, largestDimension, isColorManaged, encodedData, maxCost, isDeepImageKept);
+    pendingReads.insert(filePath, future);
+    if (maxCost >= 0)
+        sizeLimitedReads.insert(filePath);
+    else
+        sizeLimitedReads.remove(filePath);
+
+    auto *readFutureWatcher = new QFutureWatcher<QVImageCore::ReadData>(this);
+    connect(readFutureWatcher, &QFutureWatcher<QVImageCore::ReadData>::finished, this, [readFutureWatcher, filePath, future, this](){
+        // A newer read of the same file may have replaced this one after a settings change
+        auto pendingRead = pendingReads.find(filePath);
+        if (pendingRead != pendingReads.end() && *pendingRead == future)
+        {
+            pendingReads.erase(pendingRead);
+            sizeLimitedReads.remove(filePath);
+        }
+        addToCache(readFutureWatcher->result());
+        readFutureWatcher->deleteLater();
+    });
+    readFutureWatcher->setFuture(future);
+
+    return future;
+}
+
+void ImageManager::requestPreloads(const QObject *requester, const QString &currentFilePath, const QStringList &filePaths, int decodedFileCount)
+{
+    if (!requestedFiles.contains(requester))
+    {
+        connect(requester, &QObject::destroyed, this, [requester, this](){
+            releaseRequester(requester);
+        });
+    }
+
+    QStringList pinnedFiles = filePaths;
+    if (!currentFilePath.isEmpty())
+        pinnedFiles.prepend(currentFilePath);
+    requestedFiles.insert(requester, pinnedFiles);
+
+    updateCacheLimit();
+
+    // Nothing new is decoded ahead of time while the system is short on memory
+    if (memoryPressure != MemoryPressure::none)
+        return;
+
+    // The list is nearest first, the files past the decoded ones are only read into memory
+    if (decodedFileCount < 0)
+        decodedFileCount = filePaths.size();
+
+    for (const auto &filePath : filePaths.mid(0, decodedFileCount))
+    {
+        //check if image is already loaded or requested
+        if (cache.contains(filePath) || pendingReads.contains(filePath))
+            continue;
+
+        // Images too big for the cache are left alone, the worker can tell from the header without holding up this thread
+        requestRead(filePath, cacheLimit/2);
+    }
+
+    for (int i = decodedFileCount; i < filePaths.size(); i++)
+    {
+        const QString &filePath = filePaths.at(i);
+        if (!cache.contains(filePath) && !pendingReads.contains(filePath))
+            requestEncodedRead(filePath);
+    }
+
+    trimCache();
+}
+
+void ImageManager::releaseRequester(const QObject *requester)
+{
+    requestedFiles.remove(requester);
+    trimCache();
+}
+
+void ImageManager::addToCache(const QVImageCore::ReadData &readData)
+{
+    // Converted under a color management setting that has changed since
+    if (readData.image.isNull() || readData.isColorManaged != isColorManaged)
+        return;
+
+    PerformanceMonitor::Timer insertTimer("cache insert");
+
+    const QString filePath = readData.fileInfo.absoluteFilePath();
+
+    // Promoted to a decoded image, so the file contents aren't needed anymore
+    auto encodedEntry = encodedCache.find(filePath);
+    if (encodedEntry != encodedCache.end())
+    {
+        encodedCacheSize -= encodedEntry->cost;
+        encodedCache.erase(encodedEntry);
+    }
+
+    CacheEntry entry;
+    entry.image = readData.image;
+    entry.deepImage = readData.deepImage;
+    entry.imageSize = readData.size;
+    entry.frameCount = readData.frameCount;
+    entry.isAnimated = readData.isAnimated;
+    entry.fileSize = readData.fileInfo.size();
+    // What the images actually take, a deep original adds to its 8-bit copy
+    entry.cost = (static_cast<qint64>(readData.image.bytesPerLine())*readData.image.height() +
+                  static_cast<qint64>(readData.deepImage.bytesPerLine())*readData.deepImage.height())/1024;
+    entry.lastUsed = ++useCounter;
+
+    recordDecode(readData.decodeTime, entry.cost);
+
+    auto previousEntry = cache.constFind(filePath);
+    if (previousEntry != cache.constEnd())
+        cacheSize -= previousEntry->cost;
+
+    cache.insert(filePath, entry);
+    cacheSize += entry.cost;
+
+    trimCache();
+}
+
+void ImageManager::requestEncodedRead(const QString &filePath)
+{
+    if (encodedCache.contains(filePath) || pendingEncodedReads.contains(filePath))
+        return;
+
+    auto future = QtConcurrent::run(&encodedReadPool, [filePath]{
+        // Whatever the user is looking at comes first when the disk or the CPU is busy
+        QThread::currentThread()->setPriority(QThread::LowPriority);
+
+        QElapsedTimer readTimer;
+        readTimer.start();
+        const QByteArray data = QVImageCore::readEncodedFile(filePath);
+        return qMakePair(data, readTimer.elapsed());
+    });
+    pendingEncodedReads.insert(filePath, future);
+
+    auto *readFutureWatcher = new QFutureWatcher<QPair<QByteArray, qint64>>(this);
+    connect(readFutureWatcher, &QFutureWatcher<QPair<QByteArray, qint64>>::finished, this, [readFutureWatcher, filePath, this](){
+        pendingEncodedReads.remove(filePath);
+        const QPair<QByteArray, qint64> result = readFutureWatcher->result();
+        addToEncodedCache(filePath, result.first, result.second);
+        readFutureWatcher->deleteLater();
+    });
+    readFutureWatcher->setFuture(future);
+}
+
+void ImageManager::addToEncodedCache(const QString &filePath, const QByteArray &data, qint64 readTime)
+{
+    // Nothing to keep if it failed or got decoded in the meantime
+    if (data.isEmpty() || cache.contains(filePath))
+        return;
+
+    EncodedEntry entry;
+    entry.data = data;
+    entry.fileSize = QFileInfo(filePath).size();
+    entry.cost = qMax<qint64>(1, data.size()/1024);
+    entry.lastUsed = ++useCounter;
+
+    const double weight = encodedReadCount == 0 ? 1.0 : 0.25;
+    averageEncodedCost += (entry.cost - averageEncodedCost) * weight;
+    averageEncodedReadTime += (readTime - averageEncodedReadTime) * weight;
+    encodedReadCount++;
+
+    auto previousEntry = encodedCache.constFind(filePath);
+    if (previousEntry != encodedCache.constEnd())
+        encodedCacheSize -= previousEntry->cost;
+
+    encodedCache.insert(filePath, entry);
+    encodedCacheSize += entry.cost;
+
+    trimCache();
+}
+
+void ImageManager::recordDecode(qint64 decodeTime, qint64 cost)
+{
+    // Weighted towards recent images so the averages follow the folder being browsed
+    const double weight = decodeCount == 0 ? 1.0 : 0.25;
+    averageDecodeTime += (decodeTime - averageDecodeTime) * weight;
+    averageCost += (cost - averageCost) * weight;
+    decodeCount++;
+}
+
+int ImageManager::getPreloadingDistance() const
+{
+    // Nothing to go by yet
+    if (decodeCount == 0)
+        return 4;
+
+    // As many neighbours on each side as fit in the decoded share of the cache next to the current image
+    const qint64 imageCost = qMax<qint64>(1, qRound64(averageCost));
+    const qint64 memoryDistance = (cacheLimit*3/4/imageCost - 1)/2;
+
+    // Preloads queue in front of whatever the user jumps to next, so both sides together
+    // shouldn't take the decoding threads longer than the latency target to get through.
+    // Far preloads still being read hold up the disk for that jump too, so they come off the target first.
+    const int threadCount = qMax(1, QThreadPool::globalInstance()->maxThreadCount());
+    const double latencyBudget = qMax(0.0, targetLatency - pendingEncodedReads.size()*averageEncodedReadTime);
+    const qint64 latencyDistance = qRound64(latencyBudget*threadCount/qMax(1.0, averageDecodeTime)/2);
+
+    return static_cast<int>(qBound<qint64>(1, qMin(memoryDistance, latencyDistance), maxPreloadingDistance));
+}
+
+int ImageManager::getSlideshowPreloadingDistance(int interval) const
+{
+    if (decodeCount == 0 || interval <= 0)
+        return getPreloadingDistance();
+
+    // Each slide gets decoded while the ones before it are on screen, so slow decodes on short
+    // intervals need to start several slides early. One more covers a file that is slower than usual.
+    const qint64 deadlineDistance = static_cast<qint64>(qCeil(averageDecodeTime/interval)) + 1;
+
+    // Nothing is kept behind, so all of the decoded share of the cache can go ahead
+    const qint64 imageCost = qMax<qint64>(1, qRound64(averageCost));
+    const qint64 memoryDistance = cacheLimit*3/4/imageCost - 1;
+
+    return static_cast<int>(qBound<qint64>(1, qMin(deadlineDistance, memoryDistance), maxPreloadingDistance));
+}
+
+int ImageManager::getEncodedPreloadingDistance() const
+{
+    if (decodeCount == 0)
+        return 0;
+
+    // Until a file has been read, guess that it's a tenth of its decoded size like a typical photo
+    const double encodedCost = encodedReadCount == 0 ? averageCost/10 : averageEncodedCost;
+    const qint64 memoryDistance = qRound64(cacheLimit/4/qMax(1.0, encodedCost)/2);
+
+    return static_cast<int>(qBound<qint64>(0, memoryDistance, maxEncodedPreloadingDistance));
+}
+
+void ImageManager::updateCacheLimit()
+{
+    cacheLimit = budgetLimit;
+
+    // Never take more than half of the memory the rest of the system has left
+    const qint64 availableMemory = getAvailableMemory();
+    if (availableMemory >= 0)
+        cacheLimit = qMin(cacheLimit, cacheSize + encodedCacheSize + availableMemory/2);
+
+    trimCache();
+}
+
+qint64 ImageManager::getAvailableMemory()
+{
+#ifdef Q_OS_LINUX
+    QFile memInfo("/proc/meminfo");
+    if (!memInfo.open(QIODevice::ReadOnly | QIODevice::Text))
+        return -1;
+
+    const QList<QByteArray> lines = memInfo.readAll().split('\n');
+    for (const auto &line : lines)
+    {
+        if (line.startsWith("MemAvailable:"))
+            return line.mid(13).trimmed().split(' ').constFirst().toLongLong();
+    }
+#endif
+    return -1;
+}
+
+ImageManager::MemoryPressure ImageManager::getMemoryPressure()
+{
+#ifdef Q_OS_LINUX
+    // Pressure stall information says how much time tasks spent waiting on memory lately
+    QFile pressureFile("/proc/pressure/memory");
+    if (pressureFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        double someAverage = 0;
+        double fullAverage = 0;
+        const QList<QByteArray> lines = pressureFile.readAll().split('\n');
+        for (const auto &line : lines)
+        {
+            const int averageIndex = line.indexOf("avg10=");
+            if (averageIndex == -1)
+                continue;
+
+            const double average = line.mid(averageIndex + 6).split(' ').constFirst().toDouble();
+            if (line.startsWith("some"))
+                someAverage = average;
+            else if (line.startsWith("full"))
+                fullAverage = average;
+        }
+
+        if (fullAverage >= 5)
+            return MemoryPressure::critical;
+        if (someAverage >= 10)
+            return MemoryPressure::moderate;
+        return MemoryPressure::none;
+    }
+
+    // Older kernels only have the amount of memory left to go by
+    QFile memInfo("/proc/meminfo");
+    if (!memInfo.open(QIODevice::ReadOnly | QIODevice::Text))
+        return MemoryPressure::none;
+
+    qint64 totalMemory = 0;
+    qint64 availableMemory = -1;
+    const QList<QByteArray> lines = memInfo.readAll().split('\n');
+    for (const auto &line : lines)
+    {
+        if (line.startsWith("MemTotal:"))
+            totalMemory = line.mid(9).trimmed().split(' ').constFirst().toLongLong();
+        else if (line.startsWith("MemAvailable:"))
+            availableMemory = line.mid(13).trimmed().split(' ').constFirst().toLongLong();
+    }
+
+    if (totalMemory <= 0 || availableMemory < 0)
+        return MemoryPressure::none;
+    if (availableMemory < totalMemory/20)
+        return MemoryPressure::critical;
+    if (availableMemory < totalMemory/10)
+        return MemoryPressure::moderate;
+#endif
+    return MemoryPressure::none;
+}
+
+void ImageManager::checkMemoryPressure()
+{
+    const MemoryPressure previousMemoryPressure = memoryPressure;
+    memoryPressure = getMemoryPressure();
+
+    if (memoryPressure == MemoryPressure::none)
+    {
+        if (previousMemoryPressure != MemoryPressure::none)
+            qInfo() << "Memory pressure is over, preloading again";
+        return;
+    }
+
+    // Images that no window is showing or preloading go first
+    QSet<QString> keptFiles = getPinnedFiles();
+
+    // If that isn't enough, each window also gives up the far half of its preloads,
+    // the lists are nearest first and always start with the image being shown
+    if (memoryPressure == MemoryPressure::critical)
+    {
+        keptFiles.clear();
+        for (auto &filePaths : requestedFiles)
+        {
+            filePaths = filePaths.mid(0, qMax(1, (filePaths.size()+1)/2));
+            for (const auto &filePath : qAsConst(filePaths))
+                keptFiles.insert(filePath);
+        }
+    }
+
+    evictUnpinnedEntries(keptFiles, memoryPressure == MemoryPressure::critical ? "critical memory pressure" : "memory pressure");
+}
+
+void ImageManager::evictUnpinnedEntries(const QSet<QString> &keptFiles, const QString &reason)
+{
+    int evictedCount = 0;
+    qint64 evictedSize = 0;
+    for (auto it = cache.begin(); it != cache.end();)
+    {
+        if (keptFiles.contains(it.key()))
+        {
+            ++it;
+            continue;
+        }
+
+        evictedCount++;
+        evictedSize += it->cost;
+        cacheSize -= it->cost;
+        it = cache.erase(it);
+    }
+
+    for (auto it = encodedCache.begin(); it != encodedCache.end();)
+    {
+        if (keptFiles.contains(it.key()))
+        {
+            ++it;
+            continue;
+        }
+
+        evictedCount++;
+        evictedSize += it->cost;
+        encodedCacheSize -= it->cost;
+        it = encodedCache.erase(it);
+    }
+
+    if (evictedCount > 0)
+        qInfo().noquote() << QString("Evicted %1 cached images (%2 KiB) because of %3").arg(evictedCount).arg(evictedSize).arg(reason);
+}
+
+void ImageManager::trimCache()
+{
+    if (cacheSize + encodedCacheSize <= cacheLimit)
+        return;
+
+    // Files that any window is showing or preloading are never evicted
+    const QSet<QString> pinnedFiles = getPinnedFiles();
+
+    // Both tiers share the budget, whichever entry was used least recently goes first
+    while (cacheSize + encodedCacheSize > cacheLimit)
+    {
+        auto leastRecentlyUsed = cache.end();
+        for (auto it = cache.begin(); it != cache.end(); ++it)
+        {
+            if (pinnedFiles.contains(it.key()))
+                continue;
+
+            if (leastRecentlyUsed == cache.end() || it->lastUsed < leastRecentlyUsed->lastUsed)
+                leastRecentlyUsed = it;
+        }
+
+        auto leastRecentlyUsedEncoded = encodedCache.end();
+        for (auto it = encodedCache.begin(); it != encodedCache.end(); ++it)
+        {
+            if (pinnedFiles.contains(it.key()))
+                continue;
+
+            if (leastRecentlyUsedEncoded == encodedCache.end() || it->lastUsed < leastRecentlyUsedEncoded->lastUsed)
+                leastRecentlyUsedEncoded = it;
+        }
+
+        if (leastRecentlyUsedEncoded != encodedCache.end() &&
+                (leastRecentlyUsed == cache.end() || leastRecentlyUsedEncoded->lastUsed < leastRecentlyUsed->lastUsed))
+        {
+            encodedCacheSize -= leastRecentlyUsedEncoded->cost;
+            encodedCache.erase(leastRecentlyUsedEncoded);
+        }
+        else if (leastRecentlyUsed != cache.end())
+        {
+            cacheSize -= leastRecentlyUsed->cost;
+            cache.erase(leastRecentlyUsed);
+        }
+        else
+        {
+            break;
+        }
+    }
+}
+
+QSet<QString> ImageManager::getPinnedFiles() const
+{
+    QSet<QString> pinnedFiles;
+    for (const auto &filePaths : requestedFiles)
+    {
+        for (const auto &filePath : filePaths)
+            pinnedFiles.insert(filePath);
+    }
+    return pinnedFiles;
+}
+
+void ImageManager::settingsUpdated()
+{
+    auto &settingsManager = qvApp->getSettingsManager();
+
+    //preloading budget, nothing is kept when preloading is disabled
+    budgetLimit = static_cast<qint64>(settingsManager.getInteger("preloadingbudget"))*1024;
+    if (settingsManager.getInteger("preloadingmode") == 0)
+        budgetLimit = 0;
+
+    //color management, images that were converted the other way have to be decoded again
+    const bool newIsColorManaged = settingsManager.getBoolean("colormanagement");
+    if (newIsColorManaged != isColorManaged)
+    {
+        cache.clear();
+        cacheSize = 0;
+
+        // Reads that are still running are dropped when they finish, so nobody should wait on them either
+        pendingReads.clear();
+    }
+    isColorManaged = newIsColorManaged;
+
+    isDeepImageKept = settingsManager.getBoolean("scalingenabled");
+
+    updateCacheLimit();
+}
@@ -0,0 +1,141 @@
+#ifndef IMAGEMANAGER_H
+#define IMAGEMANAGER_H
+
+#include "qvimagecore.h"
+
+#include <QObject>
+#include <QFuture>
+#include <QHash>
+#include <QSet>
+#include <QThreadPool>
+
+class ImageManager : public QObject
+{
+    Q_OBJECT
+public:
+    enum class MemoryPressure
+    {
+        none,
+        moderate,
+        critical
+    };
+
+    struct CacheEntry
+    {
+        QImage image;
+        QImage deepImage;
+        QSize imageSize;
+        int frameCount;
+        bool isAnimated;
+        qint64 fileSize;
+        qint64 cost;
+        quint64 lastUsed;
+    };
+
+    // Far preloads keep just the contents of the file, which are a fraction of the decoded size
+    struct EncodedEntry
+    {
+        QByteArray data;
+        qint64 fileSize;
+        qint64 cost;
+        quint64 lastUsed;
+    };
+
+    explicit ImageManager(QObject *parent = nullptr);
+
+    bool findCachedImage(const QFileInfo &fileInfo, QVImageCore::ReadData &readData);
+
+    QFuture<QVImageCore::ReadData> requestRead(const QString &filePath, qint64 maxCost = -1);
+
+    void requestPreloads(const QObject *requester, const QString &currentFilePath, const QStringList &filePaths, int decodedFileCount = -1);
+
+    void releaseRequester(const QObject *requester);
+
+    void settingsUpdated();
+
+    int getPreloadingDistance() const;
+
+    int getEncodedPreloadingDistance() const;
+
+    int getSlideshowPreloadingDistance(int interval) const;
+
+    int getLargestDimension() const { return largestDimension; }
+
+    qint64 getCacheLimit() const { return cacheLimit; }
+
+    qint64 getCacheSize() const { return cacheSize; }
+
+    int getPendingReadCount() const { return pendingReads.size() + pendingEncodedReads.size(); }
+
+protected:
+    void addToCache(const QVImageCore::ReadData &readData);
+
+    void requestEncodedRead(const QString &filePath);
+
+    void addToEncodedCache(const QString &filePath, const QByteArray &data, qint64 readTime);
+
+    void recordDecode(qint64 decodeTime, qint64 cost);
+
+    void updateCacheLimit();
+
+    static qint64 getAvailableMemory();
+
+    static MemoryPressure getMemoryPressure();
+
+    void checkMemoryPressure();
+
+    void evictUnpinnedEntries(const QSet<QString> &keptFiles, const QString &reason);
+
+    void trimCache();
+
+    QSet<QString> getPinnedFiles() const;
+
+private:
+    QHash<QString, CacheEntry> cache;
+
+    QHash<QString, QFuture<QVImageCore::ReadData>> pendingReads;
+
+    // Pending preloads that may give up on a large image, so nobody waiting to see the image shares them
+    QSet<QString> sizeLimitedReads;
+
+    QHash<QString, EncodedEntry> encodedCache;
+
+    QHash<QString, QFuture<QPair<QByteArray, qint64>>> pendingEncodedReads;
+
+    // Far preloads only wait on the disk, so they get a thread of their own instead of holding up decodes
+    QThreadPool encodedReadPool;
+
+    QHash<const QObject*, QStringList> requestedFiles;
+
+    // Sizes are in KiB, like QPixmapCache
+    qint64 budgetLimit;
+    qint64 cacheLimit;
+    qint64 cacheSize;
+    qint64 encodedCacheSize;
+
+    // Running averages of the images decoded lately, used to size the preloading window
+    double averageDecodeTime;
+    double averageCost;
+    int decodeCount;
+    double averageEncodedCost;
+    double averageEncodedReadTime;
+    int encodedReadCount;
+
+    quint64 useCounter;
+
+    int largestDimension;
+
+    bool isColorManaged;
+
+    // Deep originals are only worth their memory when high quality scaling is going to use them
+    bool isDeepImageKept;
+
+    MemoryPressure memoryPressure;
+
+    // Milliseconds of queued decoding that a jump to an image that isn't preloaded may wait behind
+    const double targetLatency = 500;
+    const int maxPreloadingDistance = 64;
+    const int maxEncodedPreloadingDistance = 128;
+};
+
+#endif // IMAGEMANAGER_H
@@ -1,25 +1,99 @@
 #include "mainwindow.h"
 #include "qvapplication.h"
+#include "filelistreader.h"
+#include "batchconverter.h"
 
 #include <QCommandLineParser>
 
 int main(int argc, char *argv[])
 {
+    QVApplication::traceStartup("Process started");
+
+    // Batch conversion never shows a window, so it shouldn't need a display either
+    for (int i = 1; i < argc; i++)
+    {
+        if (qstrcmp(argv[i], "--convert") == 0 && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
     QCoreApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
     QCoreApplication::setOrganizationName("qView");
     QCoreApplication::setApplicationName("qView");
     QCoreApplication::setApplicationVersion(QString::number(VERSION));
     QVApplication app(argc, argv);
 
+    // The files were passed to a qView instance that is already running
+    if (app.getIsSecondaryInstance())
+        return 0;
+
     QCommandLineParser parser;
     parser.addHelpOption();
     parser.addVersionOption();
-    parser.addPositionalArgument(QObject::tr("file"), QObject::tr("The file to open."));
+    parser.addPositionalArgument(QObject::tr("files"), QObject::tr("The files to open, or - to read a newline or NUL separated list from standard input."), QObject::tr("[files...]"));
+    QCommandLineOption convertOption("convert", QObject::tr("Convert the files into <folder> instead of opening them."), QObject::tr("folder"));
+    QCommandLineOption sizeOption("size", QObject::tr("Shrink converted images to fit within <width>x<height>."), QObject::tr("width>x<height"));
+    QCommandLineOption rotateOption("rotate", QObject::tr("Rotate converted images clockwise by <degrees>, a multiple of 90."), QObject::tr("degrees"));
+    QCommandLineOption formatOption("format", QObject::tr("Save converted images as <format> instead of their own format."), QObject::tr("format"));
+    QCommandLineOption qualityOption("quality", QObject::tr("Save converted images with <quality> from 0 to 100."), QObject::tr("quality"));
+    parser.addOptions({convertOption, sizeOption, rotateOption, formatOption, qualityOption});
     parser.process(app);
 
+    if (parser.isSet(convertOption))
+    {
+        BatchConverter::Options options;
+        options.outputPath = parser.value(convertOption);
+        options.format = parser.value(formatOption).toLatin1();
+        options.quality = parser.isSet(qualityOption) ? parser.value(qualityOption).toInt() : -1;
+
+        const QStringList sizeParts = parser.value(sizeOption).split('x');
+        if (sizeParts.size() == 2)
+            options.size = QSize(sizeParts.at(0).toInt(), sizeParts.at(1).toInt());
+        if (parser.isSet(sizeOption) && !options.size.isValid())
+            parser.showHelp(1);
+
+        options.rotation = parser.value(rotateOption).toInt();
+        if (options.rotation % 90 != 0)
+            parser.showHelp(1);
+        options.rotation = (options.rotation % 360 + 360) % 360;
+
+        return BatchConverter::run(parser.positionalArguments(), options);
+    }
+
+    // Only a process that shows a window should receive files from later launches
+    app.startInstanceServer();
+
     auto *window = QVApplication::newWindow();
-    if (!parser.positionalArguments().isEmpty())
-        QVApplication::openFile(window, parser.positionalArguments().constFirst(), true);
+    QVApplication::traceStartup("First window shown");
+
+    QStringList files = parser.positionalArguments();
+    if (files.removeAll("-") > 0)
+    {
+        // Show the first files as soon as they arrive and keep adding the rest while they are read
+        auto *fileListReader = new FileListReader(stdin);
+        QObject::connect(fileListReader, &FileListReader::filesRead, window, [window, files, isFirstBatch = true, openedFiles = QStringList()](const QStringList &readFiles) mutable {
+            if (isFirstBatch)
+            {
+                openedFiles = files + readFiles;
+                QVApplication::openFiles(window, openedFiles, true);
+                isFirstBatch = false;
+            }
+            else if (openedFiles.size() == 1)
+            {
+                // A lone first file was opened by browsing its folder, so the playlist has to start with it
+                window->appendFiles(openedFiles + readFiles);
+                openedFiles.clear();
+            }
+            else
+            {
+                window->appendFiles(readFiles);
+            }
+        });
+        fileListReader->start();
+    }
+    else if (!files.isEmpty())
+    {
+        QVApplication::openFiles(window, files, true);
+    }
 
     return QApplication::exec();
 }
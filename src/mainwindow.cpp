@@ -3,6 +3,8 @@
 #include "qvapplication.h"
 #include "qvcocoafunctions.h"
 #include "qvrenamedialog.h"
+#include "qvgotodialog.h"
+#include "archivereader.h"
 
 #include <QFileDialog>
 #include <QMessageBox>
@@ -24,14 +26,13 @@
 #include <QScreen>
 #include <QCursor>
 #include <QInputDialog>
+#include <QSharedPointer>
+#include <QSet>
 #include <QProgressDialog>
 #include <QFutureWatcher>
 #include <QtConcurrent/QtConcurrentRun>
 #include <QMenu>
 #include <QWindow>
-#include <QNetworkRequest>
-#include <QNetworkReply>
-#include <QTemporaryFile>
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
@@ -51,8 +52,42 @@ MainWindow::MainWindow(QWidget *parent) :
     // Hide fullscreen label by default
     ui->fullscreenLabel->hide();
 
+    // Performance overlay drawn over the top left corner of the image
+    performanceLabel = new QLabel(graphicsView);
+    performanceLabel->setAttribute(Qt::WA_TransparentForMouseEvents);
+    performanceLabel->setStyleSheet("QLabel { background-color: rgba(0, 0, 0, 160); color: white; padding: 4px; }");
+    performanceLabel->move(6, 6);
+    performanceLabel->hide();
+
+    performanceTimer = new QTimer(this);
+    performanceTimer->setInterval(500);
+    connect(performanceTimer, &QTimer::timeout, this, &MainWindow::updatePerformanceOverlay);
+
+    // Thumbnail strip, hidden until asked for
+    thumbnailStrip = new QVThumbnailStrip(this);
+    connect(thumbnailStrip, &QVThumbnailStrip::fileActivated, this, [this](int index){
+        graphicsView->goToFile(QVGraphicsView::GoToFileMode::constant, index);
+    });
+
+    thumbnailDock = new QDockWidget(tr("Thumbnails"), this);
+    thumbnailDock->setObjectName("thumbnailDock");
+    thumbnailDock->setFeatures(QDockWidget::DockWidgetClosable);
+    thumbnailDock->setTitleBarWidget(new QWidget(thumbnailDock));
+    thumbnailDock->setWidget(thumbnailStrip);
+    addDockWidget(Qt::BottomDockWidgetArea, thumbnailDock);
+    thumbnailDock->hide();
+    connect(thumbnailDock, &QDockWidget::visibilityChanged, this, [this](bool visible){
+        const auto thumbnailsActions = qvApp->getActionManager().getAllClonesOfAction("thumbnails", this);
+        for (const auto &thumbnailsAction : thumbnailsActions)
+            thumbnailsAction->setText(visible ? tr("Hide &Thumbnails") : tr("Show &Thumbnails"));
+
+        if (visible)
+            updateThumbnails();
+    });
+
     // Connect graphicsview signals
     connect(graphicsView, &QVGraphicsView::fileChanged, this, &MainWindow::fileChanged);
+    connect(graphicsView, &QVGraphicsView::folderListChanged, this, &MainWindow::updateThumbnails);
     connect(graphicsView, &QVGraphicsView::updatedLoadedPixmapItem, this, &MainWindow::setWindowSize);
     connect(graphicsView, &QVGraphicsView::cancelSlideshow, this, &MainWindow::cancelSlideshow);
 
@@ -70,8 +105,8 @@ MainWindow::MainWindow(QWidget *parent) :
     info = new QVInfoDialog(this);
 
     // Timer for slideshow
-    slideshowTimer = new QTimer(this);
-    connect(slideshowTimer, &QTimer::timeout, this, &MainWindow::slideshowAction);
+    slideshowScheduler = new SlideshowScheduler(this);
+    connect(slideshowScheduler, &SlideshowScheduler::advance, this, &MainWindow::slideshowAction);
 
     // Context menu
     auto &actionManager = qvApp->getActionManager();
@@ -148,7 +183,9 @@ MainWindow::MainWindow(QWidget *parent) :
     {
         settings.setValue("firstlaunch", true);
         settings.setValue("configversion", VERSION);
-        qvApp->openWelcomeDialog(this);
+        QTimer::singleShot(0, this, [this]{
+            qvApp->openWelcomeDialog(this);
+        });
     }
 }
 
@@ -254,6 +291,17 @@ void MainWindow::openFile(const QString &fileName)
     cancelSlideshow();
 }
 
+void MainWindow::openFiles(const QStringList &fileNames)
+{
+    graphicsView->loadFiles(fileNames);
+    cancelSlideshow();
+}
+
+void MainWindow::appendFiles(const QStringList &fileNames)
+{
+    graphicsView->appendFiles(fileNames);
+}
+
 void MainWindow::settingsUpdated()
 {
     auto &settingsManager = qvApp->getSettingsManager();
@@ -274,10 +322,25 @@ void MainWindow::settingsUpdated()
 #endif
 
     //slideshow timer
-    slideshowTimer->setInterval(static_cast<int>(settingsManager.getDouble("slideshowtimer")*1000));
+    slideshowScheduler->setInterval(static_cast<int>(settingsManager.getDouble("slideshowtimer")*1000));
+    if (slideshowScheduler->isActive())
+        graphicsView->setSlideshowDirection(settingsManager.getBoolean("slideshowreversed") ? -1 : 1, slideshowScheduler->getInterval());
 
 
     ui->fullscreenLabel->setVisible(qvApp->getSettingsManager().getBoolean("fullscreendetails") && (windowState() == Qt::WindowFullScreen));
+
+    //performance overlay
+    const bool isPerformanceOverlayEnabled = settingsManager.getBoolean("performanceoverlay");
+    performanceLabel->setVisible(isPerformanceOverlayEnabled);
+    if (isPerformanceOverlayEnabled)
+    {
+        updatePerformanceOverlay();
+        performanceTimer->start();
+    }
+    else
+    {
+        performanceTimer->stop();
+    }
 }
 
 void MainWindow::shortcutsUpdated()
@@ -307,6 +370,8 @@ void MainWindow::fileChanged()
 {
     requestPopulateOpenWithMenu();
     disableActions();
+    updateThumbnails();
+    prepareNextSlide();
 
     refreshProperties();
     buildWindowTitle();
@@ -314,6 +379,10 @@ void MainWindow::fileChanged()
 
 void MainWindow::disableActions()
 {
+    // Images inside an archive have no file of their own to delete, rename or show in a folder
+    const bool isFileOnDisk = getCurrentFileDetails().isPixmapLoaded &&
+            !ArchiveReader::isArchiveMember(getCurrentFileDetails().fileInfo.absoluteFilePath());
+
     const auto &actionLibrary = qvApp->getActionManager().getActionLibrary();
     for (const auto &action : actionLibrary)
     {
@@ -330,6 +399,10 @@ void MainWindow::disableActions()
                 {
                     clone->setEnabled(getCurrentFileDetails().isPixmapLoaded);
                 }
+                else if (cloneData.last() == "filedisable")
+                {
+                    clone->setEnabled(isFileOnDisk);
+                }
                 else if (cloneData.last() == "gifdisable")
                 {
                     clone->setEnabled(getCurrentFileDetails().isMovieLoaded);
@@ -349,10 +422,25 @@ void MainWindow::disableActions()
     const auto &openWithMenus = qvApp->getActionManager().getAllClonesOfMenu("openwith");
     for (const auto &menu : openWithMenus)
     {
-        menu->setEnabled(getCurrentFileDetails().isPixmapLoaded);
+        menu->setEnabled(isFileOnDisk);
     }
 }
 
+void MainWindow::updatePerformanceOverlay()
+{
+    const auto &imageManager = qvApp->getImageManager();
+
+    QString overlayText = qvApp->getPerformanceMonitor().getSummary();
+    if (!overlayText.isEmpty())
+        overlayText += '\n';
+    overlayText += tr("queued reads: %1").arg(imageManager.getPendingReadCount());
+    overlayText += '\n' + tr("cache: %1 of %2 MiB").arg(imageManager.getCacheSize()/1024).arg(imageManager.getCacheLimit()/1024);
+
+    performanceLabel->setText(overlayText);
+    performanceLabel->adjustSize();
+    performanceLabel->raise();
+}
+
 void MainWindow::requestPopulateOpenWithMenu()
 {
     openWithFutureWatcher.setFuture(QtConcurrent::run([&]{
@@ -402,7 +490,7 @@ void MainWindow::refreshProperties()
 void MainWindow::buildWindowTitle()
 {
     QString newString = "qView";
-    if (getCurrentFileDetails().fileInfo.isFile())
+    if (getCurrentFileDetails().fileInfo.isFile() || ArchiveReader::isArchiveMember(getCurrentFileDetails().fileInfo.absoluteFilePath()))
     {
         switch (qvApp->getSettingsManager().getInteger("titlebarmode")) {
         case 1:
@@ -539,68 +627,113 @@ void MainWindow::setJustLaunchedWithImage(bool value)
 
 void MainWindow::openUrl(const QUrl &url)
 {
-    if (!url.isValid()) {
-        QMessageBox::critical(this, tr("Error"), tr("Error: URL is invalid"));
-        return;
+    openUrls({url});
+}
+
+void MainWindow::openUrls(const QList<QUrl> &urls)
+{
+    for (const auto &url : urls)
+    {
+        if (!url.isValid()) {
+            QMessageBox::critical(this, tr("Error"), tr("Error: URL is invalid"));
+            return;
+        }
     }
 
-    auto request = QNetworkRequest(url);
-    auto *reply = networkAccessManager.get(request);
-    auto *progressDialog = new QProgressDialog(tr("Downloading image..."), tr("Cancel"), 0, 100);
+    auto &downloadManager = qvApp->getDownloadManager();
+
+    auto *progressDialog = new QProgressDialog(urls.size() == 1 ? tr("Downloading image...") : tr("Downloading %n images...", nullptr, urls.size()),
+                                               tr("Cancel"), 0, urls.size() == 1 ? 100 : urls.size());
     progressDialog->setWindowFlag(Qt::WindowContextHelpButtonHint, false);
     progressDialog->setAutoClose(false);
     progressDialog->setAutoReset(false);
     progressDialog->setWindowTitle(tr("Open URL..."));
     progressDialog->open();
 
-    connect(progressDialog, &QProgressDialog::canceled, reply, [reply]{
-        reply->abort();
+    // Files are opened together in the order they were given once every download is done
+    auto filePaths = QSharedPointer<QHash<QUrl, QString>>::create();
+    auto errorStrings = QSharedPointer<QStringList>::create();
+    auto remainingUrls = QSharedPointer<QSet<QUrl>>::create();
+    for (const auto &url : urls)
+        remainingUrls->insert(url);
+
+    // Other windows may be waiting on the same transfers, so this window stops listening instead of waiting for them to fail
+    connect(progressDialog, &QProgressDialog::canceled, this, [progressDialog, remainingUrls, &downloadManager]{
+        const auto urlsToCancel = *remainingUrls;
+        remainingUrls->clear();
+        for (const auto &url : urlsToCancel)
+            downloadManager.cancel(url);
+
+        progressDialog->close();
+        progressDialog->deleteLater();
     });
 
-    connect(reply, &QNetworkReply::downloadProgress, progressDialog, [progressDialog](qreal bytesReceived, qreal bytesTotal){
-        auto percent = (bytesReceived/bytesTotal)*100;
-        progressDialog->setValue(qRound(percent));
-    });
+    if (urls.size() == 1)
+    {
+        connect(&downloadManager, &DownloadManager::downloadProgress, progressDialog, [progressDialog, remainingUrls](const QUrl &url, qint64 bytesReceived, qint64 bytesTotal){
+            if (!remainingUrls->contains(url))
+                return;
 
+            // Servers that don't send a length get a busy indicator instead
+            if (bytesTotal <= 0)
+            {
+                progressDialog->setMaximum(0);
+                return;
+            }
 
-    connect(reply, &QNetworkReply::finished, progressDialog, [progressDialog, reply, this]{
-        if (reply->error())
-        {
-            progressDialog->close();
-            QMessageBox::critical(this, tr("Error"), tr("Error ") + QString::number(reply->error()) + ": " + reply->errorString());
+            progressDialog->setValue(qRound(static_cast<qreal>(bytesReceived)/bytesTotal*100));
+        });
+    }
+
+    auto urlDone = [progressDialog, urls, filePaths, errorStrings, remainingUrls, this](const QUrl &url){
+        remainingUrls->remove(url);
+        if (urls.size() > 1)
+            progressDialog->setValue(urls.size() - remainingUrls->size());
 
-            progressDialog->deleteLater();
+        if (!remainingUrls->isEmpty())
             return;
+
+        progressDialog->close();
+        progressDialog->deleteLater();
+
+        if (!errorStrings->isEmpty())
+            QMessageBox::critical(this, tr("Error"), errorStrings->join('\n'));
+
+        QStringList files;
+        for (const auto &requestedUrl : urls)
+        {
+            if (filePaths->contains(requestedUrl))
+                files.append(filePaths->value(requestedUrl));
         }
 
-        progressDialog->setMaximum(0);
+        if (!files.isEmpty())
+            openFiles(files);
+    };
 
-        auto *tempFile = new QTemporaryFile(this);
-        tempFile->setFileTemplate(qvApp->applicationName() + ".XXXXXX.png");
+    connect(&downloadManager, &DownloadManager::downloadFinished, progressDialog, [filePaths, errorStrings, remainingUrls, urlDone, this](const QUrl &url, const QString &filePath){
+        if (!remainingUrls->contains(url))
+            return;
 
-        auto *saveFutureWatcher = new QFutureWatcher<bool>();
-        connect(saveFutureWatcher, &QFutureWatcher<bool>::finished, this, [progressDialog, tempFile, saveFutureWatcher, this](){
-            progressDialog->close();
-            if (saveFutureWatcher->result())
-            {
-                if (tempFile->open())
-                {
-                    openFile(tempFile->fileName());
-                }
-            }
-            else
-            {
-                 QMessageBox::critical(this, tr("Error"), tr("Error: Invalid image"));
-                 tempFile->deleteLater();
-            }
-            progressDialog->deleteLater();
-            saveFutureWatcher->deleteLater();
-        });
+        // Only the header is read here, the image itself is decoded once by the normal loading path
+        QImageReader imageReader(filePath, QVImageCore::detectFormat(filePath));
+        if (imageReader.canRead())
+            filePaths->insert(url, filePath);
+        else
+            errorStrings->append(tr("Error: Invalid image") + " (" + url.toDisplayString() + ")");
+
+        urlDone(url);
+    });
+
+    connect(&downloadManager, &DownloadManager::downloadFailed, progressDialog, [errorStrings, remainingUrls, urlDone](const QUrl &url, const QString &errorString){
+        if (!remainingUrls->contains(url))
+            return;
 
-        saveFutureWatcher->setFuture(QtConcurrent::run([reply, tempFile]{
-            return QImage::fromData(reply->readAll()).save(tempFile, "png");
-        }));
+        errorStrings->append(errorString + " (" + url.toDisplayString() + ")");
+        urlDone(url);
     });
+
+    for (const auto &url : urls)
+        downloadManager.download(url);
 }
 
 void MainWindow::pickUrl()
@@ -628,7 +761,7 @@ void MainWindow::openWith(const OpenWith::OpenWithItem &openWithItem)
 
 void MainWindow::openContainingFolder()
 {
-    if (!getCurrentFileDetails().isPixmapLoaded)
+    if (!getCurrentFileDetails().isPixmapLoaded || ArchiveReader::isArchiveMember(getCurrentFileDetails().fileInfo.absoluteFilePath()))
         return;
 
     const QFileInfo selectedFileInfo = getCurrentFileDetails().fileInfo;
@@ -651,6 +784,9 @@ void MainWindow::showFileInfo()
 
 void MainWindow::askDeleteFile()
 {    
+    if (ArchiveReader::isArchiveMember(getCurrentFileDetails().fileInfo.absoluteFilePath()))
+        return;
+
     if (!qvApp->getSettingsManager().getBoolean("askdelete"))
     {
         deleteFile();
@@ -811,11 +947,24 @@ void MainWindow::paste()
 
     if (mimeData->hasText())
     {
-        auto url = QUrl(mimeData->text());
+        // A list of links is downloaded in parallel and opened as one sequence
+        QList<QUrl> urls;
+        const QStringList lines = mimeData->text().simplified().split(' ');
+        for (const auto &line : lines)
+        {
+            auto url = QUrl(line);
+
+            if (!url.isValid() || (url.scheme() != "http" && url.scheme() != "https"))
+            {
+                urls.clear();
+                break;
+            }
+            urls.append(url);
+        }
 
-        if (url.isValid() && (url.scheme() == "http" || url.scheme() == "https"))
+        if (!urls.isEmpty())
         {
-            openUrl(url);
+            openUrls(urls);
             return;
         }
     }
@@ -825,7 +974,7 @@ void MainWindow::paste()
 
 void MainWindow::rename()
 {
-    if (!getCurrentFileDetails().isPixmapLoaded)
+    if (!getCurrentFileDetails().isPixmapLoaded || ArchiveReader::isArchiveMember(getCurrentFileDetails().fileInfo.absoluteFilePath()))
         return;
 
     auto *renameDialog = new QVRenameDialog(this, getCurrentFileDetails().fileInfo);
@@ -903,6 +1052,15 @@ void MainWindow::lastFile()
     graphicsView->goToFile(QVGraphicsView::GoToFileMode::last);
 }
 
+void MainWindow::goToFile()
+{
+    if (getCurrentFileDetails().folderFileInfoList.isEmpty())
+        return;
+
+    auto *goToDialog = new QVGoToDialog(graphicsView, this);
+    goToDialog->open();
+}
+
 void MainWindow::saveFrameAs()
 {
     QSettings settings;
@@ -966,13 +1124,29 @@ void MainWindow::nextFrame()
     graphicsView->jumpToNextFrame();
 }
 
+void MainWindow::toggleThumbnails()
+{
+    thumbnailDock->setVisible(!thumbnailDock->isVisible());
+}
+
+void MainWindow::updateThumbnails()
+{
+    // Nothing is listed or decoded for a strip nobody can see
+    if (!thumbnailDock->isVisible())
+        return;
+
+    const auto &fileDetails = getCurrentFileDetails();
+    thumbnailStrip->setFolder(fileDetails.folderFileInfoList, fileDetails.folderListGeneration, fileDetails.loadedIndexInFolder);
+}
+
 void MainWindow::toggleSlideshow()
 {
     const auto slideshowActions = qvApp->getActionManager().getAllClonesOfAction("slideshow", this);
 
-    if (slideshowTimer->isActive())
+    if (slideshowScheduler->isActive())
     {
-        slideshowTimer->stop();
+        slideshowScheduler->stop();
+        graphicsView->setSlideshowDirection(0);
         for (const auto &slideshowAction : slideshowActions)
         {
             slideshowAction->setText(tr("Start S&lideshow"));
@@ -981,7 +1155,9 @@ void MainWindow::toggleSlideshow()
     }
     else
     {
-        slideshowTimer->start();
+        slideshowScheduler->start();
+        graphicsView->setSlideshowDirection(qvApp->getSettingsManager().getBoolean("slideshowreversed") ? -1 : 1, slideshowScheduler->getInterval());
+        prepareNextSlide();
         for (const auto &slideshowAction : slideshowActions)
         {
             slideshowAction->setText(tr("Stop S&lideshow"));
@@ -992,13 +1168,35 @@ void MainWindow::toggleSlideshow()
 
 void MainWindow::cancelSlideshow()
 {
-    if (slideshowTimer->isActive())
+    if (slideshowScheduler->isActive())
         toggleSlideshow();
 }
 
+void MainWindow::prepareNextSlide()
+{
+    if (!slideshowScheduler->isActive())
+        return;
+
+    // Same stepping as goToFile, so the slide being decoded is the one the next tick shows
+    const QFileInfoList &fileInfoList = getCurrentFileDetails().folderFileInfoList;
+    const int direction = qvApp->getSettingsManager().getBoolean("slideshowreversed") ? -1 : 1;
+    int nextIndex = getCurrentFileDetails().loadedIndexInFolder + direction;
+    if (qvApp->getSettingsManager().getBoolean("loopfoldersenabled") && !fileInfoList.isEmpty())
+        nextIndex = (nextIndex + fileInfoList.size()) % fileInfoList.size();
+
+    QString nextFilePath;
+    if (getCurrentFileDetails().loadedIndexInFolder >= 0 && nextIndex >= 0 && nextIndex < fileInfoList.size())
+        nextFilePath = fileInfoList.at(nextIndex).absoluteFilePath();
+
+    slideshowScheduler->slideShown(nextFilePath);
+}
+
 void MainWindow::slideshowAction()
 {
-    if (qvApp->getSettingsManager().getBoolean("slideshowreversed"))
+    const bool isReversed = qvApp->getSettingsManager().getBoolean("slideshowreversed");
+    graphicsView->setSlideshowDirection(isReversed ? -1 : 1, slideshowScheduler->getInterval());
+
+    if (isReversed)
         previousFile();
     else
         nextFile();
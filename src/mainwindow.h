@@ -5,10 +5,13 @@
 #include "qvimagecore.h"
 #include "qvgraphicsview.h"
 #include "openwith.h"
+#include "qvthumbnailstrip.h"
+#include "slideshowscheduler.h"
 
 #include <QMainWindow>
 #include <QShortcut>
-#include <QNetworkAccessManager>
+#include <QLabel>
+#include <QDockWidget>
 #include <QStack>
 
 namespace Ui {
@@ -49,6 +52,8 @@ public:
 
     void openUrl(const QUrl &url);
 
+    void openUrls(const QList<QUrl> &urls);
+
     void pickUrl();
 
     void openContainingFolder();
@@ -95,6 +100,8 @@ public:
 
     void lastFile();
 
+    void goToFile();
+
     void saveFrameAs();
 
     void pause();
@@ -109,21 +116,33 @@ public:
 
     void toggleFullScreen();
 
+    void toggleThumbnails();
+
+    void updateThumbnails();
+
     const QVImageCore::FileDetails& getCurrentFileDetails() const { return graphicsView->getCurrentFileDetails(); }
 
 public slots:
     void openFile(const QString &fileName);
 
+    void openFiles(const QStringList &fileNames);
+
+    void appendFiles(const QStringList &fileNames);
+
     void toggleSlideshow();
 
     void slideshowAction();
 
     void cancelSlideshow();
 
+    void prepareNextSlide();
+
     void fileChanged();
 
     void disableActions();
 
+    void updatePerformanceOverlay();
+
 protected:
     bool event(QEvent *event) override;
 
@@ -150,7 +169,13 @@ private:
     QMenu *contextMenu;
     QMenu *virtualMenu;
 
-    QTimer *slideshowTimer;
+    SlideshowScheduler *slideshowScheduler;
+
+    QLabel *performanceLabel;
+    QTimer *performanceTimer;
+
+    QDockWidget *thumbnailDock;
+    QVThumbnailStrip *thumbnailStrip;
 
     QShortcut *escShortcut;
 
@@ -160,8 +185,6 @@ private:
 
     Qt::WindowStates storedWindowState;
 
-    QNetworkAccessManager networkAccessManager;
-
     QStack<DeletedPaths> lastDeletedFiles;
 
     QFutureWatcher<QList<OpenWith::OpenWithItem>> openWithFutureWatcher;
@@ -0,0 +1,140 @@
+#include "performancemonitor.h"
+#include "qvapplication.h"
+
+#include <QThread>
+
+PerformanceMonitor::Timer::Timer(const char *name) : name(name)
+{
+    auto *monitor = getInstance();
+    startTime = monitor && monitor->getIsEnabled() ? monitor->getTimestamp() : -1;
+}
+
+PerformanceMonitor::Timer::~Timer()
+{
+    finish();
+}
+
+void PerformanceMonitor::Timer::finish()
+{
+    if (startTime < 0)
+        return;
+
+    auto *monitor = getInstance();
+    if (monitor)
+        monitor->addEvent(name, startTime, monitor->getTimestamp());
+    startTime = -1;
+}
+
+PerformanceMonitor::PerformanceMonitor(QObject *parent) : QObject(parent)
+{
+    isEnabled = false;
+    cacheHits = 0;
+    cacheMisses = 0;
+
+    monitorTimer.start();
+
+    // To use: QVIEW_TRACE_FILE=/path/to/trace.json
+    const QString traceFileName = QString::fromLocal8Bit(qgetenv("QVIEW_TRACE_FILE"));
+    if (!traceFileName.isEmpty())
+        openTraceFile(traceFileName);
+
+    // Connect to settings signal
+    connect(&qvApp->getSettingsManager(), &SettingsManager::settingsUpdated, this, &PerformanceMonitor::settingsUpdated);
+    settingsUpdated();
+}
+
+PerformanceMonitor::~PerformanceMonitor()
+{
+    QMutexLocker locker(&mutex);
+    if (traceFile.isOpen())
+    {
+        traceFile.write(QString("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%1,\"args\":{\"name\":\"qView\"}}]\n")
+                        .arg(QCoreApplication::applicationPid()).toUtf8());
+        traceFile.close();
+    }
+}
+
+PerformanceMonitor *PerformanceMonitor::getInstance()
+{
+    auto *application = qvApp;
+    return application ? &application->getPerformanceMonitor() : nullptr;
+}
+
+void PerformanceMonitor::addEvent(const char *name, qint64 startTime, qint64 endTime)
+{
+    const double duration = (endTime - startTime)/1000000.0;
+
+    QMutexLocker locker(&mutex);
+
+    auto it = statistics.find(name);
+    if (it == statistics.end())
+    {
+        it = statistics.insert(name, Statistics());
+        eventOrder.append(name);
+    }
+
+    // Weighted towards recent events so the overlay follows what is happening now
+    it->averageTime = it->count == 0 ? duration : it->averageTime + (duration - it->averageTime) * 0.1;
+    it->lastTime = duration;
+    it->count++;
+
+    if (traceFile.isOpen())
+    {
+        traceFile.write(QString("{\"name\":\"%1\",\"cat\":\"qView\",\"ph\":\"X\",\"ts\":%2,\"dur\":%3,\"pid\":%4,\"tid\":%5},\n")
+                        .arg(QString::fromLatin1(name))
+                        .arg(startTime/1000.0, 0, 'f', 3)
+                        .arg((endTime - startTime)/1000.0, 0, 'f', 3)
+                        .arg(QCoreApplication::applicationPid())
+                        .arg(reinterpret_cast<quintptr>(QThread::currentThreadId()))
+                        .toUtf8());
+    }
+}
+
+void PerformanceMonitor::addCacheLookup(bool isHit)
+{
+    if (!isEnabled)
+        return;
+
+    QMutexLocker locker(&mutex);
+    if (isHit)
+        cacheHits++;
+    else
+        cacheMisses++;
+}
+
+QString PerformanceMonitor::getSummary() const
+{
+    QMutexLocker locker(&mutex);
+
+    QStringList lines;
+    for (const auto &name : eventOrder)
+    {
+        const Statistics &eventStatistics = statistics.value(name);
+        lines << tr("%1: %2 ms (average %3 ms)").arg(QString::fromLatin1(name))
+                 .arg(eventStatistics.lastTime, 0, 'f', 1).arg(eventStatistics.averageTime, 0, 'f', 1);
+    }
+
+    const int cacheLookups = cacheHits + cacheMisses;
+    if (cacheLookups > 0)
+        lines << tr("cache hits: %1% of %2").arg(100.0*cacheHits/cacheLookups, 0, 'f', 0).arg(cacheLookups);
+
+    return lines.join('\n');
+}
+
+void PerformanceMonitor::settingsUpdated()
+{
+    QMutexLocker locker(&mutex);
+    isEnabled = qvApp->getSettingsManager().getBoolean("performanceoverlay") || traceFile.isOpen();
+}
+
+void PerformanceMonitor::openTraceFile(const QString &fileName)
+{
+    traceFile.setFileName(fileName);
+    if (!traceFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning().noquote() << QString("Couldn't open trace file %1: %2").arg(fileName, traceFile.errorString());
+        return;
+    }
+
+    traceFile.write("[\n");
+}
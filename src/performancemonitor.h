@@ -0,0 +1,73 @@
+#ifndef PERFORMANCEMONITOR_H
+#define PERFORMANCEMONITOR_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <atomic>
+
+class PerformanceMonitor : public QObject
+{
+    Q_OBJECT
+public:
+    struct Statistics
+    {
+        int count = 0;
+        double lastTime = 0;
+        double averageTime = 0;
+    };
+
+    // Times the enclosing scope, usable from any thread
+    class Timer
+    {
+    public:
+        explicit Timer(const char *name);
+        ~Timer();
+
+        void finish();
+
+    private:
+        const char *name;
+        qint64 startTime;
+    };
+
+    explicit PerformanceMonitor(QObject *parent = nullptr);
+    ~PerformanceMonitor() override;
+
+    static PerformanceMonitor *getInstance();
+
+    bool getIsEnabled() const { return isEnabled; }
+
+    qint64 getTimestamp() const { return monitorTimer.nsecsElapsed(); }
+
+    void addEvent(const char *name, qint64 startTime, qint64 endTime);
+
+    void addCacheLookup(bool isHit);
+
+    QString getSummary() const;
+
+    void settingsUpdated();
+
+protected:
+    void openTraceFile(const QString &fileName);
+
+private:
+    std::atomic<bool> isEnabled;
+
+    QElapsedTimer monitorTimer;
+
+    mutable QMutex mutex;
+
+    QHash<QByteArray, Statistics> statistics;
+    QList<QByteArray> eventOrder;
+
+    int cacheHits;
+    int cacheMisses;
+
+    // Chrome trace event format, loadable in about:tracing or Perfetto
+    QFile traceFile;
+};
+
+#endif // PERFORMANCEMONITOR_H
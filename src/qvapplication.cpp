@@ -2,14 +2,68 @@
 #include "qvoptionsdialog.h"
 #include "qvcocoafunctions.h"
 #include "updatechecker.h"
+#include "archivereader.h"
 
 #include <QFileOpenEvent>
 #include <QSettings>
 #include <QTimer>
 #include <QFileDialog>
+#include <QElapsedTimer>
+#include <QCryptographicHash>
+#include <QLocalSocket>
+#include <QUrl>
+#include <QDataStream>
 
 QVApplication::QVApplication(int &argc, char **argv) : QApplication(argc, argv)
 {
+    traceStartup("Qt and application managers initialized");
+
+    dockMenu = nullptr;
+    menuBar = nullptr;
+    imageManager = nullptr;
+    downloadManager = nullptr;
+    thumbnailManager = nullptr;
+    instanceServer = nullptr;
+    isSecondaryInstance = false;
+
+    // Hand files off to an already running instance before doing any expensive setup
+    if (settingsManager.getBoolean("singleinstance"))
+    {
+        QStringList files;
+        bool hasOptions = false;
+        const auto args = arguments().mid(1);
+        for (const auto &arg : args)
+        {
+            if (arg.startsWith('-'))
+            {
+                hasOptions = true;
+                break;
+            }
+
+            // The running instance has a different working directory, so relative paths must be resolved here
+            const QUrl url(arg);
+            if (url.isLocalFile())
+                files << url.toLocalFile();
+            else if (url.scheme().length() > 1) // Single letter schemes are windows drive letters
+                files << arg;
+            else
+                files << QFileInfo(arg).absoluteFilePath();
+        }
+
+        // Options like --help or --version should be handled by this process, and
+        // main() only starts the server for them once it knows a window will be shown
+        if (!hasOptions)
+        {
+            if (sendToRunningInstance(files))
+            {
+                isSecondaryInstance = true;
+                return;
+            }
+
+            startInstanceServer();
+        }
+    }
+
     // Connections
     connect(&actionManager, &ActionManager::recentsMenuUpdated, this, &QVApplication::recentsMenuUpdated);
     connect(&updateChecker, &UpdateChecker::checkedUpdates, this, &QVApplication::checkedUpdates);
@@ -19,33 +73,45 @@ QVApplication::QVApplication(int &argc, char **argv) : QApplication(argc, argv)
     QIcon::setFallbackSearchPaths(QIcon::fallbackSearchPaths() << "/usr/share/pixmaps");
 #endif
 
-    // Initialize list of supported files and filters
-    const auto byteArrayList = QImageReader::supportedImageFormats();
-    for (const auto &byteArray : byteArrayList)
-    {
-        auto fileExtString = QString::fromUtf8(byteArray);
-        // Qt 5.15 seems to have added pdf support for QImageReader but it is super broken in qView at the moment
-        if (fileExtString == "pdf")
-            continue;
+    // Set mac-specific application settings
+#ifdef COCOA_LOADED
+    QVCocoaFunctions::setUserDefaults();
+#endif
+#ifdef Q_OS_MACOS
+    setQuitOnLastWindowClosed(false);
+#endif
 
-        filterList << "*." + fileExtString;
-    }
+    // Block any erroneous icons from showing up on mac and windows
+    // (this is overridden in some cases)
+#if defined Q_OS_MACOS || defined Q_OS_WIN
+    setAttribute(Qt::AA_DontShowIconsInMenus);
+#endif
+    // Adwaita Qt styles should hide icons for a more consistent look
+    if (style()->objectName() == "adwaita-dark" || style()->objectName() == "adwaita")
+        setAttribute(Qt::AA_DontShowIconsInMenus);
 
-    auto filterString = tr("Supported Images") + " (";
-    for (const auto &filter : qAsConst(filterList))
-    {
-        filterString += filter + " ";
-    }
-    filterString.chop(1);
-    filterString += ")";
+    hideIncompatibleActions();
 
-    nameFilterList << filterString;
-    nameFilterList << tr("All Files") + " (*)";
+    // Everything that isn't needed to show the first window waits until the event loop is running
+    QTimer::singleShot(0, this, &QVApplication::deferredInitialization);
+    traceStartup("Application constructed");
+}
 
-    // Check for updates
-    // TODO: move this to after first window show event
-    if (getSettingsManager().getBoolean("updatenotifications"))
-        checkUpdates();
+QVApplication::~QVApplication() {
+    if (dockMenu)
+        dockMenu->deleteLater();
+    if (menuBar)
+        menuBar->deleteLater();
+
+    // Before the settings manager they depend on goes away
+    delete thumbnailManager;
+    delete downloadManager;
+    delete imageManager;
+}
+
+void QVApplication::deferredInitialization()
+{
+    traceStartup("Event loop started");
 
     // Setup macOS dock menu
     dockMenu = new QMenu();
@@ -53,8 +119,6 @@ QVApplication::QVApplication(int &argc, char **argv) : QApplication(argc, argv)
        ActionManager::actionTriggered(triggeredAction);
     });
 
-    actionManager.loadRecentsList();
-
 #ifdef Q_OS_MACOS
     dockMenu->addAction(actionManager.cloneAction("newwindow"));
     dockMenu->addAction(actionManager.cloneAction("open"));
@@ -66,30 +130,147 @@ QVApplication::QVApplication(int &argc, char **argv) : QApplication(argc, argv)
     connect(menuBar, &QMenuBar::triggered, this, [](QAction *triggeredAction){
         ActionManager::actionTriggered(triggeredAction);
     });
+    traceStartup("Global menus built");
 
-    // Set mac-specific application settings
-#ifdef COCOA_LOADED
-    QVCocoaFunctions::setUserDefaults();
-#endif
-#ifdef Q_OS_MACOS
-    setQuitOnLastWindowClosed(false);
-#endif
+    // Checks that every recent file still exists
+    actionManager.loadRecentsList();
+    traceStartup("Recent files checked");
 
-    // Block any erroneous icons from showing up on mac and windows
-    // (this is overridden in some cases)
-#if defined Q_OS_MACOS || defined Q_OS_WIN
-    setAttribute(Qt::AA_DontShowIconsInMenus);
-#endif
-    // Adwaita Qt styles should hide icons for a more consistent look
-    if (style()->objectName() == "adwaita-dark" || style()->objectName() == "adwaita")
-        setAttribute(Qt::AA_DontShowIconsInMenus);
+    // Loads every image plugin, unless an opened file needed them already
+    getFilterList();
+    traceStartup("Image formats enumerated");
 
-    hideIncompatibleActions();
+    // Old thumbnails are cleaned up in the background once the first window is up
+    getThumbnailManager().startDiskCachePruning();
+
+    // Check for updates
+    if (getSettingsManager().getBoolean("updatenotifications"))
+        checkUpdates();
+    traceStartup("Startup finished");
 }
 
-QVApplication::~QVApplication() {
-    dockMenu->deleteLater();
-    menuBar->deleteLater();
+ImageManager &QVApplication::getImageManager()
+{
+    if (!imageManager)
+        imageManager = new ImageManager();
+    return *imageManager;
+}
+
+DownloadManager &QVApplication::getDownloadManager()
+{
+    if (!downloadManager)
+        downloadManager = new DownloadManager();
+    return *downloadManager;
+}
+
+ThumbnailManager &QVApplication::getThumbnailManager()
+{
+    if (!thumbnailManager)
+        thumbnailManager = new ThumbnailManager();
+    return *thumbnailManager;
+}
+
+void QVApplication::traceStartup(const QString &phase)
+{
+    static const bool isStartupTraceEnabled = qEnvironmentVariableIsSet("QVIEW_TRACE_STARTUP");
+    if (!isStartupTraceEnabled)
+        return;
+
+    static QElapsedTimer startupTimer;
+    static qint64 lastElapsed = 0;
+    if (!startupTimer.isValid())
+        startupTimer.start();
+
+    const qint64 elapsed = startupTimer.elapsed();
+    qInfo().noquote() << QString("Startup: %1 took %2 ms (%3 ms total)").arg(phase, QString::number(elapsed-lastElapsed), QString::number(elapsed));
+    lastElapsed = elapsed;
+}
+
+const QStringList &QVApplication::getFilterList()
+{
+    if (filterList.isEmpty())
+        buildFilterLists();
+
+    return filterList;
+}
+
+const QStringList &QVApplication::getNameFilterList()
+{
+    if (nameFilterList.isEmpty())
+        buildFilterLists();
+
+    return nameFilterList;
+}
+
+void QVApplication::buildFilterLists()
+{
+    // Asking Qt for the supported formats loads every image plugin, so the answer is kept
+    // between launches for as long as the installed plugins stay the same
+    QSettings settings;
+    settings.beginGroup("imageformats");
+
+    const QByteArray pluginSignature = getImagePluginSignature();
+    QStringList formats;
+    if (settings.value("pluginsignature").toByteArray() == pluginSignature)
+        formats = settings.value("formats").toStringList();
+
+    if (formats.isEmpty())
+    {
+        const auto byteArrayList = QImageReader::supportedImageFormats();
+        for (const auto &byteArray : byteArrayList)
+        {
+            formats << QString::fromUtf8(byteArray);
+        }
+
+        settings.setValue("pluginsignature", pluginSignature);
+        settings.setValue("formats", formats);
+    }
+
+    // Initialize list of supported files and filters
+    for (const auto &fileExtString : qAsConst(formats))
+    {
+        // Qt 5.15 seems to have added pdf support for QImageReader but it is super broken in qView at the moment
+        if (fileExtString == "pdf")
+            continue;
+
+        filterList << "*." + fileExtString;
+    }
+
+    auto filterString = tr("Supported Images") + " (";
+    for (const auto &filter : qAsConst(filterList))
+    {
+        filterString += filter + " ";
+    }
+    filterString.chop(1);
+    filterString += ")";
+
+    nameFilterList << filterString;
+    nameFilterList << tr("Archives") + " (" + ArchiveReader::getNameFilters().join(' ') + ")";
+    nameFilterList << tr("All Files") + " (*)";
+}
+
+QByteArray QVApplication::getImagePluginSignature()
+{
+    // Changes whenever qView, Qt or any image plugin is updated, added or removed
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray(qVersion()));
+
+    const QFileInfo applicationFileInfo(applicationFilePath());
+    hash.addData(QByteArray::number(applicationFileInfo.lastModified().toMSecsSinceEpoch()));
+
+    const auto libraryPaths = QCoreApplication::libraryPaths();
+    for (const auto &libraryPath : libraryPaths)
+    {
+        const auto pluginFileInfos = QDir(libraryPath + "/imageformats").entryInfoList(QDir::Files, QDir::Name);
+        for (const auto &pluginFileInfo : pluginFileInfos)
+        {
+            hash.addData(pluginFileInfo.absoluteFilePath().toUtf8());
+            hash.addData(QByteArray::number(pluginFileInfo.size()));
+            hash.addData(QByteArray::number(pluginFileInfo.lastModified().toMSecsSinceEpoch()));
+        }
+    }
+
+    return hash.result().toHex();
 }
 
 bool QVApplication::event(QEvent *event)
@@ -121,6 +302,19 @@ void QVApplication::openFile(const QString &file, bool resize)
     QVApplication::openFile(window, file, resize);
 }
 
+void QVApplication::openFiles(MainWindow *window, const QStringList &files, bool resize)
+{
+    window->setJustLaunchedWithImage(resize);
+    window->openFiles(files);
+}
+
+void QVApplication::openFiles(const QStringList &files, bool resize)
+{
+    auto *window = qvApp->getMainWindow(true);
+
+    QVApplication::openFiles(window, files, resize);
+}
+
 void QVApplication::pickFile(MainWindow *parent)
 {
     QSettings settings;
@@ -134,16 +328,10 @@ void QVApplication::pickFile(MainWindow *parent)
         fileDialog->setWindowModality(Qt::WindowModal);
 
     connect(fileDialog, &QFileDialog::filesSelected, fileDialog, [parent](const QStringList &selected){
-        bool isFirstLoop = true;
-        for (const auto &file : selected)
-        {
-            if (isFirstLoop && parent)
-                parent->openFile(file);
-            else
-                QVApplication::openFile(file);
-
-            isFirstLoop = false;
-        }
+        if (parent)
+            parent->openFiles(selected);
+        else
+            QVApplication::openFiles(selected);
 
         // Set lastFileDialogDir
         QSettings settings;
@@ -240,38 +428,6 @@ void QVApplication::recentsMenuUpdated()
 #endif
 }
 
-qint64 QVApplication::getPreviouslyRecordedFileSize(const QString &fileName)
-{
-    auto previouslyRecordedFileSizePtr = previouslyRecordedFileSizes.object(fileName);
-    qint64 previouslyRecordedFileSize = 0;
-
-    if (previouslyRecordedFileSizePtr)
-        previouslyRecordedFileSize = *previouslyRecordedFileSizePtr;
-
-    return previouslyRecordedFileSize;
-}
-
-void QVApplication::setPreviouslyRecordedFileSize(const QString &fileName, long long *fileSize)
-{
-    previouslyRecordedFileSizes.insert(fileName, fileSize);
-}
-
-QSize QVApplication::getPreviouslyRecordedImageSize(const QString &fileName)
-{
-    auto previouslyRecordedImageSizePtr = previouslyRecordedImageSizes.object(fileName);
-    QSize previouslyRecordedImageSize = QSize();
-
-    if (previouslyRecordedImageSizePtr)
-        previouslyRecordedImageSize = *previouslyRecordedImageSizePtr;
-
-    return previouslyRecordedImageSize;
-}
-
-void QVApplication::setPreviouslyRecordedImageSize(const QString &fileName, QSize *imageSize)
-{
-    previouslyRecordedImageSizes.insert(fileName, imageSize);
-}
-
 void QVApplication::addToLastActiveWindows(MainWindow *window)
 {
     if (!window)
@@ -349,6 +505,100 @@ void QVApplication::openAboutDialog(QWidget *parent)
     aboutDialog->show();
 }
 
+QString QVApplication::getInstanceServerName()
+{
+    // Include the home folder so instances of different users never talk to each other
+    return applicationName() + "-" + QString::number(qHash(QDir::homePath()), 16);
+}
+
+bool QVApplication::sendToRunningInstance(const QStringList &files)
+{
+    QLocalSocket socket;
+    socket.connectToServer(getInstanceServerName());
+    if (!socket.waitForConnected(500))
+        return false;
+
+    QByteArray message;
+    QDataStream stream(&message, QIODevice::WriteOnly);
+    stream << files;
+
+    socket.write(message);
+    if (!socket.waitForBytesWritten(1000))
+        return false;
+
+    socket.disconnectFromServer();
+    return true;
+}
+
+void QVApplication::startInstanceServer()
+{
+    if (instanceServer || !settingsManager.getBoolean("singleinstance"))
+        return;
+
+    instanceServer = new QLocalServer(this);
+    instanceServer->setSocketOptions(QLocalServer::UserAccessOption);
+
+    // A leftover socket from an instance that crashed is only removed once nothing answers on it,
+    // since another instance may have started listening after this one tried to connect
+    if (!instanceServer->listen(getInstanceServerName()))
+    {
+        QLocalSocket socket;
+        socket.connectToServer(getInstanceServerName());
+        if (socket.waitForConnected(500))
+        {
+            socket.disconnectFromServer();
+            qWarning() << "Single instance server is already running in another process";
+            return;
+        }
+
+        QLocalServer::removeServer(getInstanceServerName());
+        if (!instanceServer->listen(getInstanceServerName()))
+        {
+            qWarning() << "Failed to start single instance server:" << instanceServer->errorString();
+            return;
+        }
+    }
+
+    connect(instanceServer, &QLocalServer::newConnection, this, [this]{
+        while (auto *socket = instanceServer->nextPendingConnection())
+        {
+            connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+            connect(socket, &QLocalSocket::readyRead, this, [socket, this]{
+                QDataStream stream(socket);
+                stream.startTransaction();
+
+                QStringList files;
+                stream >> files;
+
+                // Wait for the rest of the message
+                if (!stream.commitTransaction())
+                    return;
+
+                instanceMessageReceived(files);
+            });
+        }
+    });
+
+    traceStartup("Single instance server started");
+}
+
+void QVApplication::instanceMessageReceived(const QStringList &files)
+{
+    MainWindow *window = nullptr;
+    if (files.isEmpty())
+    {
+        window = newWindow();
+    }
+    else
+    {
+        window = getMainWindow(true);
+        openFiles(window, files);
+    }
+
+    window->raise();
+    window->activateWindow();
+}
+
 void QVApplication::hideIncompatibleActions()
 {    
     // Deletion actions
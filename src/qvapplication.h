@@ -6,11 +6,16 @@
 #include "shortcutmanager.h"
 #include "actionmanager.h"
 #include "updatechecker.h"
+#include "performancemonitor.h"
+#include "imagemanager.h"
+#include "downloadmanager.h"
+#include "thumbnailmanager.h"
 #include "qvoptionsdialog.h"
 #include "qvaboutdialog.h"
 #include "qvwelcomedialog.h"
 
 #include <QApplication>
+#include <QLocalServer>
 
 #if defined(qvApp)
 #undef qvApp
@@ -28,10 +33,18 @@ public:
 
     bool event(QEvent *event) override;
 
+    void deferredInitialization();
+
+    static void traceStartup(const QString &phase);
+
     static void openFile(MainWindow *window, const QString &file, bool resize = true);
 
     static void openFile(const QString &file, bool resize = true);
 
+    static void openFiles(MainWindow *window, const QStringList &files, bool resize = true);
+
+    static void openFiles(const QStringList &files, bool resize = true);
+
     static void pickFile(MainWindow *parent = nullptr);
 
     static void pickUrl(MainWindow *parnet = nullptr);
@@ -46,14 +59,6 @@ public:
 
     void recentsMenuUpdated();
 
-    qint64 getPreviouslyRecordedFileSize(const QString &fileName);
-
-    void setPreviouslyRecordedFileSize(const QString &fileName, long long *fileSize);
-
-    QSize getPreviouslyRecordedImageSize(const QString &fileName);
-
-    void setPreviouslyRecordedImageSize(const QString &fileName, QSize *imageSize);
-
     void addToLastActiveWindows(MainWindow *window);
 
     void deleteFromLastActiveWindows(MainWindow *window);
@@ -66,11 +71,15 @@ public:
 
     void hideIncompatibleActions();
 
+    bool getIsSecondaryInstance() const { return isSecondaryInstance; }
+
+    void startInstanceServer();
+
     QMenuBar *getMenuBar() const {  return menuBar; }
 
-    const QStringList &getFilterList() const { return filterList; }
+    const QStringList &getFilterList();
 
-    const QStringList &getNameFilterList() const { return nameFilterList; }
+    const QStringList &getNameFilterList();
 
     SettingsManager &getSettingsManager() { return settingsManager; }
 
@@ -78,6 +87,25 @@ public:
 
     ActionManager &getActionManager() { return actionManager; }
 
+    PerformanceMonitor &getPerformanceMonitor() { return performanceMonitor; }
+
+    ImageManager &getImageManager();
+
+    DownloadManager &getDownloadManager();
+
+    ThumbnailManager &getThumbnailManager();
+
+protected:
+    void buildFilterLists();
+
+    static QByteArray getImagePluginSignature();
+
+    static QString getInstanceServerName();
+
+    bool sendToRunningInstance(const QStringList &files);
+
+    void instanceMessageReceived(const QStringList &files);
+
 private:
 
     QList<MainWindow*> lastActiveWindows;
@@ -86,9 +114,6 @@ private:
 
     QMenuBar *menuBar;
 
-    QCache<QString, qint64> previouslyRecordedFileSizes;
-    QCache<QString, QSize> previouslyRecordedImageSizes;
-
     QStringList filterList;
     QStringList nameFilterList;
 
@@ -96,12 +121,21 @@ private:
     SettingsManager settingsManager; 
     ActionManager actionManager;
     ShortcutManager shortcutManager;
+    PerformanceMonitor performanceMonitor;
+
+    // Created on first use, so handing files to a running instance or a headless run doesn't pay for them
+    ImageManager *imageManager;
+    DownloadManager *downloadManager;
+    ThumbnailManager *thumbnailManager;
 
     QPointer<QVOptionsDialog> optionsDialog;
     QPointer<QVWelcomeDialog> welcomeDialog;
     QPointer<QVAboutDialog> aboutDialog;
 
     UpdateChecker updateChecker;
+
+    QLocalServer *instanceServer;
+    bool isSecondaryInstance;
 };
 
 #endif // QVAPPLICATION_H
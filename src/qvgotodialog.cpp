@@ -0,0 +1,106 @@
+#include "qvgotodialog.h"
+
+#include <QApplication>
+#include <QDialogButtonBox>
+#include <QKeyEvent>
+#include <QSet>
+#include <QVBoxLayout>
+
+QVGoToDialog::QVGoToDialog(QVGraphicsView *graphicsView, QWidget *parent) :
+    QDialog(parent)
+{
+    setAttribute(Qt::WA_DeleteOnClose);
+    setWindowFlag(Qt::WindowContextHelpButtonHint, false);
+    setWindowTitle(tr("Go to File..."));
+
+    this->graphicsView = graphicsView;
+
+    const int fileCount = graphicsView->getCurrentFileDetails().folderFileInfoList.size();
+
+    searchLineEdit = new QLineEdit(this);
+    searchLineEdit->setPlaceholderText(tr("File number (1-%1) or start of a file name").arg(fileCount));
+    searchLineEdit->installEventFilter(this);
+
+    matchesListWidget = new QListWidget(this);
+
+    auto *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+
+    auto *layout = new QVBoxLayout(this);
+    layout->addWidget(searchLineEdit);
+    layout->addWidget(matchesListWidget);
+    layout->addWidget(buttonBox);
+
+    connect(searchLineEdit, &QLineEdit::textChanged, this, &QVGoToDialog::updateMatches);
+    connect(matchesListWidget, &QListWidget::itemActivated, this, &QVGoToDialog::goToSelectedFile);
+    connect(buttonBox, &QDialogButtonBox::accepted, this, &QVGoToDialog::goToSelectedFile);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    resize(400, 300);
+    updateMatches(QString());
+}
+
+bool QVGoToDialog::eventFilter(QObject *watched, QEvent *event)
+{
+    // Moving through the matches shouldn't need taking the focus away from typing
+    if (watched == searchLineEdit && event->type() == QEvent::KeyPress)
+    {
+        const int key = static_cast<QKeyEvent*>(event)->key();
+        if (key == Qt::Key_Up || key == Qt::Key_Down || key == Qt::Key_PageUp || key == Qt::Key_PageDown)
+        {
+            QApplication::sendEvent(matchesListWidget, event);
+            return true;
+        }
+    }
+
+    return QDialog::eventFilter(watched, event);
+}
+
+void QVGoToDialog::updateMatches(const QString &text)
+{
+    matchesListWidget->clear();
+
+    const QFileInfoList &fileInfoList = graphicsView->getCurrentFileDetails().folderFileInfoList;
+    const QString trimmedText = text.trimmed();
+    if (trimmedText.isEmpty())
+        return;
+
+    bool isNumber = false;
+    const int fileNumber = trimmedText.toInt(&isNumber);
+
+    QList<int> indexes;
+    if (isNumber && fileNumber >= 1 && fileNumber <= fileInfoList.size())
+        indexes.append(fileNumber - 1);
+
+    // Names can start with digits too, so those are matched as well, but listed only once
+    QSet<int> listedIndexes;
+    for (const int index : qAsConst(indexes))
+        listedIndexes.insert(index);
+
+    const QList<int> prefixIndexes = graphicsView->findFilesByPrefix(trimmedText, maxMatchCount);
+    for (const int index : prefixIndexes)
+    {
+        if (!listedIndexes.contains(index))
+        {
+            listedIndexes.insert(index);
+            indexes.append(index);
+        }
+    }
+
+    for (const int index : qAsConst(indexes))
+    {
+        auto *item = new QListWidgetItem(QString("%1. %2").arg(index + 1).arg(fileInfoList.at(index).fileName()), matchesListWidget);
+        item->setData(Qt::UserRole, index);
+    }
+
+    matchesListWidget->setCurrentRow(0);
+}
+
+void QVGoToDialog::goToSelectedFile()
+{
+    const QListWidgetItem *item = matchesListWidget->currentItem();
+    if (!item)
+        return;
+
+    graphicsView->goToFile(QVGraphicsView::GoToFileMode::constant, item->data(Qt::UserRole).toInt());
+    accept();
+}
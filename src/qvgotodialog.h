@@ -0,0 +1,32 @@
+#ifndef QVGOTODIALOG_H
+#define QVGOTODIALOG_H
+
+#include "qvgraphicsview.h"
+
+#include <QDialog>
+#include <QLineEdit>
+#include <QListWidget>
+
+class QVGoToDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    QVGoToDialog(QVGraphicsView *graphicsView, QWidget *parent = nullptr);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+    void updateMatches(const QString &text);
+
+    void goToSelectedFile();
+
+private:
+    QVGraphicsView *graphicsView;
+
+    QLineEdit *searchLineEdit;
+    QListWidget *matchesListWidget;
+
+    const int maxMatchCount = 100;
+};
+
+#endif // QVGOTODIALOG_H
@@ -1,6 +1,7 @@
 #include "qvgraphicsview.h"
 #include "qvapplication.h"
 #include "qvinfodialog.h"
+#include "archivereader.h"
 #include "qvcocoafunctions.h"
 #include <QWheelEvent>
 #include <QGraphicsPixmapItem>
@@ -51,6 +52,12 @@ QVGraphicsView::QVGraphicsView(QWidget *parent) : QGraphicsView(parent)
 
     connect(&imageCore, &QVImageCore::animatedFrameChanged, this, &QVGraphicsView::animatedFrameChanged);
     connect(&imageCore, &QVImageCore::fileChanged, this, &QVGraphicsView::postLoad);
+    connect(&imageCore, &QVImageCore::folderListChanged, this, &QVGraphicsView::folderListChanged);
+    connect(&imageCore, &QVImageCore::deepScaleFinished, this, [this](const QPixmap &scaledPixmap){
+        // Only replaces the 8-bit version of the same scaling, anything else means the view moved on
+        if (!isOriginalSize && loadedPixmapItem->pixmap().size() == scaledPixmap.size())
+            loadedPixmapItem->setPixmap(scaledPixmap);
+    });
     connect(&imageCore, &QVImageCore::updateLoadedPixmapItem, this, &QVGraphicsView::updateLoadedPixmapItem);
     connect(&imageCore, &QVImageCore::readError, this, &QVGraphicsView::error);
 
@@ -79,6 +86,12 @@ void QVGraphicsView::resizeEvent(QResizeEvent *event)
         centerOn(loadedPixmapItem);
 }
 
+void QVGraphicsView::paintEvent(QPaintEvent *event)
+{
+    PerformanceMonitor::Timer paintTimer("paint");
+    QGraphicsView::paintEvent(event);
+}
+
 void QVGraphicsView::dropEvent(QDropEvent *event)
 {
     QGraphicsView::dropEvent(event);
@@ -326,18 +339,20 @@ void QVGraphicsView::loadMimeData(const QMimeData *mimeData)
 
     const QList<QUrl> urlList = mimeData->urls();
 
-    bool first = true;
+    // Dropped files are browsed as one sequence instead of opening a window for each
+    QStringList localFiles;
     for (const auto &url : urlList)
     {
-        if (first)
-        {
-            loadFile(url.toString());
-            emit cancelSlideshow();
-            first = false;
-            continue;
-        }
-        QVApplication::openFile(url.toString());
+        if (url.isLocalFile())
+            localFiles.append(url.toLocalFile());
     }
+
+    if (localFiles.size() > 1)
+        loadFiles(localFiles);
+    else if (!urlList.isEmpty())
+        loadFile(urlList.constFirst().toString());
+
+    emit cancelSlideshow();
 }
 
 void QVGraphicsView::animatedFrameChanged(QRect rect)
@@ -378,6 +393,16 @@ void QVGraphicsView::loadFile(const QString &fileName)
     imageCore.loadFile(fileName);
 }
 
+void QVGraphicsView::loadFiles(const QStringList &fileNames)
+{
+    imageCore.loadPlaylist(fileNames);
+}
+
+void QVGraphicsView::appendFiles(const QStringList &fileNames)
+{
+    imageCore.appendToPlaylist(fileNames);
+}
+
 void QVGraphicsView::postLoad()
 {
     if (getCurrentFileDetails().isMovieLoaded)
@@ -510,6 +535,8 @@ void QVGraphicsView::goToFile(const GoToFileMode &mode, int index)
     switch (mode) {
     case GoToFileMode::constant:
     {
+        // A jump has no direction, so preload evenly around wherever it lands
+        imageCore.recordNavigation(0);
         newIndex = index;
         break;
     }
@@ -520,6 +547,7 @@ void QVGraphicsView::goToFile(const GoToFileMode &mode, int index)
     }
     case GoToFileMode::previous:
     {
+        imageCore.recordNavigation(-1);
         if (newIndex == 0)
         {
             if (isLoopFoldersEnabled)
@@ -533,6 +561,7 @@ void QVGraphicsView::goToFile(const GoToFileMode &mode, int index)
     }
     case GoToFileMode::next:
     {
+        imageCore.recordNavigation(1);
         if (getCurrentFileDetails().folderFileInfoList.size()-1 == newIndex)
         {
             if (isLoopFoldersEnabled)
@@ -552,7 +581,7 @@ void QVGraphicsView::goToFile(const GoToFileMode &mode, int index)
     }
 
     const QFileInfo nextImage = getCurrentFileDetails().folderFileInfoList.value(newIndex);
-    if (!nextImage.isFile())
+    if (!nextImage.isFile() && !ArchiveReader::isArchiveMember(nextImage.absoluteFilePath()))
         return;
 
     loadFile(nextImage.absoluteFilePath());
@@ -760,6 +789,11 @@ void QVGraphicsView::setSpeed(const int &desiredSpeed)
     imageCore.setSpeed(desiredSpeed);
 }
 
+void QVGraphicsView::setSlideshowDirection(int direction, int interval)
+{
+    imageCore.setSlideshowDirection(direction, interval);
+}
+
 void QVGraphicsView::rotateImage(int rotation)
 {
     imageCore.rotateImage(rotation);
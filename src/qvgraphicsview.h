@@ -38,6 +38,8 @@ public:
     QMimeData* getMimeData() const;
     void loadMimeData(const QMimeData *mimeData);
     void loadFile(const QString &fileName);
+    void loadFiles(const QStringList &fileNames);
+    void appendFiles(const QStringList &fileNames);
 
     void resetScale();
     void scaleExpensively(ScaleMode mode);
@@ -45,12 +47,15 @@ public:
 
     void goToFile(const GoToFileMode &mode, int index = 0);
 
+    QList<int> findFilesByPrefix(const QString &prefix, int maxCount) { return imageCore.findFilesByPrefix(prefix, maxCount); }
+
     void settingsUpdated();
 
     void closeImage();
     void jumpToNextFrame();
     void setPaused(const bool &desiredState);
     void setSpeed(const int &desiredSpeed);
+    void setSlideshowDirection(int direction, int interval = 0);
     void rotateImage(int rotation);
 
     const QVImageCore::FileDetails& getCurrentFileDetails() const { return imageCore.getCurrentFileDetails(); }
@@ -62,6 +67,8 @@ signals:
 
     void fileChanged();
 
+    void folderListChanged();
+
     void updatedLoadedPixmapItem();
 
 protected:
@@ -69,6 +76,8 @@ protected:
 
     void resizeEvent(QResizeEvent *event) override;
 
+    void paintEvent(QPaintEvent *event) override;
+
     void dropEvent(QDropEvent *event) override;
 
     void dragEnterEvent(QDragEnterEvent *event) override;
@@ -1,5 +1,7 @@
 #include "qvimagecore.h"
 #include "qvapplication.h"
+#include "directorywalker.h"
+#include "archivereader.h"
 #include <random>
 #include <QMessageBox>
 #include <QDir>
@@ -7,10 +9,18 @@
 #include <QSettings>
 #include <QCollator>
 #include <QtConcurrent/QtConcurrentRun>
-#include <QPixmapCache>
 #include <QIcon>
-#include <QGuiApplication>
-#include <QScreen>
+#include <QMutex>
+#include <QCache>
+#include <QBuffer>
+#include <QFile>
+#include <QSet>
+#include <QElapsedTimer>
+#include <QtEndian>
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+#include <QColorSpace>
+#include <QColorTransform>
+#endif
 
 QVImageCore::QVImageCore(QObject *parent) : QObject(parent)
 {  
@@ -18,51 +28,74 @@ QVImageCore::QVImageCore(QObject *parent) : QObject(parent)
     preloadingMode = 1;
     sortMode = 0;
     sortDescending = false;
+    isRecursiveBrowsingEnabled = false;
 
     randomSortSeed = 0;
 
-    currentRotation = 0;
+    listedSortMode = -1;
+    listedSortDescending = false;
+    playlistGeneration = 0;
+    archiveListGeneration = 0;
+    recursiveListGeneration = 0;
+    listedGeneration = 0;
+    lastListGeneration = 0;
+
+    collator.setNumericMode(true);
 
-    QPixmapCache::setCacheLimit(51200);
+    currentRotation = 0;
 
     connect(&loadedMovie, &QMovie::updated, this, &QVImageCore::animatedFrameChanged);
 
     connect(&loadFutureWatcher, &QFutureWatcher<ReadData>::finished, this, [this](){
-        loadPixmap(loadFutureWatcher.result(), false);
+        const ReadData readData = loadFutureWatcher.result();
+        if (readData.image.isNull())
+            emit readError(readData.errorNum, readData.errorString, readData.fileInfo.fileName());
+
+        loadPixmap(readData, false);
+    });
+
+    connect(&deepScaleWatcher, &QFutureWatcher<QImage>::finished, this, [this](){
+        // Canceled when the image changed while the worker was still scaling
+        if (deepScaleWatcher.isCanceled() || deepScaleWatcher.future().resultCount() == 0)
+            return;
+
+        emit deepScaleFinished(QPixmap::fromImage(deepScaleWatcher.result()));
     });
 
     fileChangeRateTimer = new QTimer(this);
     fileChangeRateTimer->setSingleShot(true);
     fileChangeRateTimer->setInterval(60);
 
-    largestDimension = 0;
-    const auto screenList = QGuiApplication::screens();
-    for (auto const &screen : screenList)
-    {
-        int largerDimension;
-        if (screen->size().height() > screen->size().width())
-        {
-            largerDimension = screen->size().height();
-        }
-        else
-        {
-            largerDimension = screen->size().width();
-        }
-
-        if (largerDimension > largestDimension)
-        {
-            largestDimension = largerDimension;
-        }
-    }
+    navigationDirection = 0;
+    navigationVelocity = 0;
+    slideshowDirection = 0;
+    slideshowInterval = 0;
+
+    // Once the user stops paging, preloading goes back to covering both sides evenly
+    navigationIdleTimer = new QTimer(this);
+    navigationIdleTimer->setSingleShot(true);
+    navigationIdleTimer->setInterval(3000);
+    connect(navigationIdleTimer, &QTimer::timeout, this, [this]{
+        navigationDirection = 0;
+        navigationVelocity = 0;
+        if (currentFileDetails.isPixmapLoaded)
+            requestCaching();
+    });
 
     // Connect to settings signal
     connect(&qvApp->getSettingsManager(), &SettingsManager::settingsUpdated, this, &QVImageCore::settingsUpdated);
     settingsUpdated();
 }
 
+QVImageCore::~QVImageCore()
+{
+    stopDirectoryWalk();
+}
+
 void QVImageCore::loadFile(const QString &fileName)
 {
-    if (loadFutureWatcher.isRunning() || fileChangeRateTimer->isActive())
+    // Slideshow ticks are spaced out already, and dropping one would leave a slide up for twice as long
+    if (loadFutureWatcher.isRunning() || (fileChangeRateTimer->isActive() && slideshowDirection == 0))
         return;
 
     QString sanitaryFileName = fileName;
@@ -75,6 +108,17 @@ void QVImageCore::loadFile(const QString &fileName)
     QFileInfo fileInfo(sanitaryFileName);
     sanitaryFileName = fileInfo.absoluteFilePath();
 
+    // Opening an archive shows its first image
+    if (ArchiveReader::isArchive(sanitaryFileName))
+    {
+        const QFileInfoList archiveFileInfoList = getArchiveFileInfoList(sanitaryFileName);
+        if (!archiveFileInfoList.isEmpty())
+        {
+            fileInfo = archiveFileInfoList.constFirst();
+            sanitaryFileName = fileInfo.absoluteFilePath();
+        }
+    }
+
     // Pause playing movie because it feels better that way
     setPaused(true);
 
@@ -82,69 +126,444 @@ void QVImageCore::loadFile(const QString &fileName)
 
 
     //check if cached already before loading the long way
-    auto previouslyRecordedFileSize = qvApp->getPreviouslyRecordedFileSize(sanitaryFileName);
-    auto *cachedPixmap = new QPixmap();
-    if (QPixmapCache::find(sanitaryFileName, cachedPixmap) &&
-        !cachedPixmap->isNull() &&
-        previouslyRecordedFileSize == fileInfo.size())
-    {
-        QSize previouslyRecordedImageSize = qvApp->getPreviouslyRecordedImageSize(sanitaryFileName);
-        ReadData readData = {
-            matchCurrentRotation(*cachedPixmap),
-            fileInfo,
-            previouslyRecordedImageSize
-        };
-        loadPixmap(readData, true);
-    }
+    auto &imageManager = qvApp->getImageManager();
+    ReadData cachedReadData;
+    const bool isCached = imageManager.findCachedImage(fileInfo, cachedReadData);
+    qvApp->getPerformanceMonitor().addCacheLookup(isCached);
+    if (isCached)
+        loadPixmap(cachedReadData, true);
     else
+        loadFutureWatcher.setFuture(imageManager.requestRead(sanitaryFileName));
+}
+
+void QVImageCore::loadPlaylist(const QStringList &fileNames)
+{
+    // Not refreshed against the image that is shown now, which isn't part of the new playlist
+    playlist.clear();
+    playlistIndexes.clear();
+    playlistGeneration = ++lastListGeneration;
+    addPlaylistEntries(fileNames);
+
+    // A single file is browsed along with the rest of its folder as usual
+    if (playlist.size() < 2)
+    {
+        playlist.clear();
+        playlistIndexes.clear();
+        if (!fileNames.isEmpty())
+            loadFile(fileNames.constFirst());
+        return;
+    }
+
+    loadFile(playlist.constFirst().absoluteFilePath());
+}
+
+void QVImageCore::appendToPlaylist(const QStringList &fileNames)
+{
+    addPlaylistEntries(fileNames);
+
+    // Files added after the first one is shown become reachable right away
+    if (currentFileDetails.isPixmapLoaded)
+    {
+        updateFolderInfo();
+        requestCaching();
+        emit folderListChanged();
+    }
+}
+
+void QVImageCore::addPlaylistEntries(const QStringList &fileNames)
+{
+    for (const auto &fileName : fileNames)
     {
-        loadFutureWatcher.setFuture(QtConcurrent::run(this, &QVImageCore::readFile, sanitaryFileName, false));
+        QString sanitaryFileName = fileName;
+
+        QUrl sanitaryUrl = QUrl(fileName);
+        if (sanitaryUrl.isLocalFile())
+            sanitaryFileName = sanitaryUrl.toLocalFile();
+
+        QFileInfo fileInfo(sanitaryFileName);
+        if (!fileInfo.isFile())
+            continue;
+
+        // A file given twice is found at its first position, like indexOf did
+        if (!playlistIndexes.contains(fileInfo.absoluteFilePath()))
+            playlistIndexes.insert(fileInfo.absoluteFilePath(), playlist.size());
+        playlist.append(fileInfo);
     }
-    delete cachedPixmap;
+
+    playlistGeneration = ++lastListGeneration;
 }
 
-QVImageCore::ReadData QVImageCore::readFile(const QString &fileName, bool forCache)
+QVImageCore::ReadData QVImageCore::readFile(const QString &fileName, int largestDimension, bool isColorManaged, const QByteArray &encodedData, qint64 maxCost, bool isDeepImageKept)
 {
+    QElapsedTimer decodeTimer;
+    decodeTimer.start();
+
+    PerformanceMonitor::Timer probeTimer("probe");
+
+    QBuffer encodedBuffer;
     QImageReader imageReader;
-    imageReader.setDecideFormatFromContent(true);
     imageReader.setAutoTransform(true);
 
-    imageReader.setFileName(fileName);
+    // Only ask every plugin whether it can read the file when the first bytes don't already say
+    QByteArray detectedFormat;
 
-    QPixmap readPixmap;
+    QString archivePath;
+    QString memberName;
+    const bool isArchiveMember = ArchiveReader::splitPath(fileName, archivePath, memberName);
+    if (!encodedData.isEmpty() || isArchiveMember)
+    {
+        // Archive members and files that were preloaded without decoding are decoded straight from memory
+        encodedBuffer.setData(encodedData.isEmpty() ? ArchiveReader::readMember(archivePath, memberName) : encodedData);
+        encodedBuffer.open(QIODevice::ReadOnly);
+        imageReader.setDevice(&encodedBuffer);
+        detectedFormat = detectFormat(&encodedBuffer);
+    }
+    else
+    {
+        imageReader.setFileName(fileName);
+        detectedFormat = detectFormat(fileName);
+    }
+
+    // Qt's own png handler is the fastest way to get the first frame of an apng
+    if (detectedFormat == "apng")
+        imageReader.setFormat("png");
+    else if (!detectedFormat.isEmpty())
+        imageReader.setFormat(detectedFormat);
+    else
+        imageReader.setDecideFormatFromContent(true);
+
+    // Count frames here so the GUI thread only opens a QMovie for actual animations.
+    // QMovie can't open archive members, so those always show their first frame.
+    int frameCount = 1;
+    bool isAnimated = false;
+    if (!isArchiveMember && detectedFormat == "apng")
+    {
+        frameCount = 0;
+        isAnimated = true;
+    }
+    else if (!isArchiveMember && imageReader.supportsAnimation())
+    {
+        // Zero means the handler can't tell without decoding every frame
+        frameCount = imageReader.imageCount();
+        isAnimated = frameCount != 1;
+    }
+
+    // Preloads give up on images that wouldn't fit in the cache anyway, judging by the header alone
+    if (maxCost >= 0)
+    {
+        const QSize size = imageReader.size();
+        int bitsPerPixel = QImage::toPixelFormat(imageReader.imageFormat()).bitsPerPixel();
+        if (bitsPerPixel <= 0)
+            bitsPerPixel = 32;
+        else if (bitsPerPixel > 32)
+            bitsPerPixel = 32 + (isDeepImageKept ? bitsPerPixel : 0);
+        const qint64 cost = static_cast<qint64>(size.width())*size.height()*bitsPerPixel/8/1024;
+        if (size.isValid() && cost > maxCost)
+        {
+            ReadData readData;
+            readData.fileInfo = QFileInfo(fileName);
+            readData.size = size;
+            readData.isColorManaged = isColorManaged;
+            readData.isSkipped = true;
+            return readData;
+        }
+    }
+
+    probeTimer.finish();
+
+    PerformanceMonitor::Timer readTimer("decode");
+    QImage readImage;
     if (imageReader.format() == "svg" || imageReader.format() == "svgz")
     {
         // Render vectors into a high resolution
         QIcon icon;
         icon.addFile(fileName);
-        readPixmap = icon.pixmap(largestDimension);
+        readImage = icon.pixmap(largestDimension).toImage();
         // If this fails, try reading the normal way so that a proper error message is given
-        if (readPixmap.isNull())
-            readPixmap = QPixmap::fromImageReader(&imageReader);
+        if (readImage.isNull())
+            readImage = imageReader.read();
     }
     else
     {
-        readPixmap = QPixmap::fromImageReader(&imageReader);
+        readImage = imageReader.read();
     }
 
+    readTimer.finish();
+
+    PerformanceMonitor::Timer convertTimer("convert");
+    // Done here on the worker thread, and before compacting since grayscale can't be transformed
+    if (isColorManaged)
+        convertToDisplayColorSpace(readImage);
+
+    QImage deepImage;
+    if (isDeepImageKept && readImage.depth() > 32)
+        deepImage = readImage;
+
+    readImage = compactImage(readImage);
+    convertTimer.finish();
+
     ReadData readData = {
-        readPixmap,
+        readImage,
+        deepImage,
         QFileInfo(fileName),
         imageReader.size(),
     };
-    // Only error out when not loading for cache
-    if (readPixmap.isNull() && !forCache)
+    readData.frameCount = frameCount;
+    readData.isAnimated = isAnimated;
+    readData.decodeTime = decodeTimer.elapsed();
+    readData.isColorManaged = isColorManaged;
+
+    // Errors are reported by whoever asked for the image, since preloads shouldn't show them
+    if (readImage.isNull())
     {
-        emit readError(imageReader.error(), imageReader.errorString(), readData.fileInfo.fileName());
+        readData.errorNum = imageReader.error();
+        readData.errorString = imageReader.errorString();
     }
 
+    return readData;
+}
+
+QByteArray QVImageCore::readEncodedFile(const QString &fileName)
+{
+    QString archivePath;
+    QString memberName;
+    if (ArchiveReader::splitPath(fileName, archivePath, memberName))
+        return ArchiveReader::readMember(archivePath, memberName);
 
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
 
-    return readData;
+    return file.readAll();
+}
+
+QImage QVImageCore::compactImage(const QImage &image)
+{
+    switch (image.format())
+    {
+    // Already as small as it gets
+    case QImage::Format_Invalid:
+    case QImage::Format_Mono:
+    case QImage::Format_MonoLSB:
+    case QImage::Format_Indexed8:
+    case QImage::Format_Grayscale8:
+    case QImage::Format_RGB888:
+        return image;
+    default:
+        break;
+    }
+
+    // More than 8 bits per channel is more than the screen shows, so this copy is reduced here on the worker
+    if (image.depth() > 32)
+        return compactImage(image.convertToFormat(image.hasAlphaChannel() ? QImage::Format_ARGB32 : QImage::Format_RGB32));
+
+    if (image.hasAlphaChannel())
+        return image;
+
+    // Scanned documents and black and white photos often come out of the decoder as full color
+    if (image.isGrayscale())
+        return image.convertToFormat(QImage::Format_Grayscale8);
+
+    return image.convertToFormat(QImage::Format_RGB888);
+}
+
+void QVImageCore::convertToDisplayColorSpace(QImage &image)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    const QColorSpace colorSpace = image.colorSpace();
+    if (!colorSpace.isValid() || colorSpace == QColorSpace::SRgb)
+        return;
+
+    // Qt 5 can't tell what profile a screen has, so everything is shown as sRGB
+    const QColorSpace displayColorSpace = QColorSpace::SRgb;
+
+    // Building a transform means inverting the profile's curves, which is worth doing once per profile
+    static QMutex colorTransformsMutex;
+    static QCache<QByteArray, QColorTransform> colorTransforms(16);
+
+    QByteArray key = colorSpace.iccProfile();
+    if (key.isEmpty())
+        key = QByteArray::number(static_cast<int>(colorSpace.primaries())) + ':' +
+                QByteArray::number(static_cast<int>(colorSpace.transferFunction())) + ':' +
+                QByteArray::number(colorSpace.gamma());
+
+    QColorTransform colorTransform;
+    {
+        QMutexLocker locker(&colorTransformsMutex);
+        if (auto *cachedTransform = colorTransforms.object(key))
+        {
+            colorTransform = *cachedTransform;
+        }
+        else
+        {
+            colorTransform = colorSpace.transformationToColorSpace(displayColorSpace);
+            colorTransforms.insert(key, new QColorTransform(colorTransform));
+        }
+    }
+
+    image.applyColorTransform(colorTransform);
+    image.setColorSpace(displayColorSpace);
+#else
+    Q_UNUSED(image)
+#endif
+}
+
+QByteArray QVImageCore::detectFormat(const QString &fileName)
+{
+    struct DetectedFormat
+    {
+        QDateTime lastModified;
+        qint64 size;
+        QByteArray format;
+    };
+
+    // Shared by every window and worker thread, so the same file is only sniffed once
+    static QMutex detectedFormatsMutex;
+    static QCache<QString, DetectedFormat> detectedFormats(4096);
+
+    const QFileInfo fileInfo(fileName);
+    {
+        QMutexLocker locker(&detectedFormatsMutex);
+        if (auto *detectedFormat = detectedFormats.object(fileName))
+        {
+            if (detectedFormat->lastModified == fileInfo.lastModified() && detectedFormat->size == fileInfo.size())
+                return detectedFormat->format;
+        }
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+
+    const QByteArray format = detectFormat(&file);
+
+    QMutexLocker locker(&detectedFormatsMutex);
+    detectedFormats.insert(fileName, new DetectedFormat{fileInfo.lastModified(), fileInfo.size(), format});
+    return format;
+}
+
+QByteArray QVImageCore::detectFormat(QIODevice *device)
+{
+    const QByteArray header = device->peek(512);
+
+    if (header.startsWith("\x89PNG\r\n\x1a\n"))
+    {
+        // Animated pngs have an acTL chunk somewhere before the first IDAT chunk
+        const qint64 startPos = device->pos();
+        QByteArray format = "png";
+        qint64 chunkPos = startPos + 8;
+        while (device->seek(chunkPos))
+        {
+            const QByteArray chunkHeader = device->read(8);
+            if (chunkHeader.size() < 8)
+                break;
+
+            const QByteArray chunkType = chunkHeader.mid(4, 4);
+            if (chunkType == "acTL")
+            {
+                format = "apng";
+                break;
+            }
+            if (chunkType == "IDAT" || chunkType == "IEND")
+                break;
+
+            const quint32 chunkLength = (static_cast<quint32>(static_cast<uchar>(chunkHeader.at(0))) << 24) |
+                                        (static_cast<quint32>(static_cast<uchar>(chunkHeader.at(1))) << 16) |
+                                        (static_cast<quint32>(static_cast<uchar>(chunkHeader.at(2))) << 8) |
+                                        static_cast<quint32>(static_cast<uchar>(chunkHeader.at(3)));
+            // Length, type, data and crc
+            chunkPos += 12 + chunkLength;
+        }
+        device->seek(startPos);
+        return format;
+    }
+
+    if (header.startsWith("\xff\xd8\xff"))
+        return "jpeg";
+    if (header.startsWith("GIF87a") || header.startsWith("GIF89a"))
+        return "gif";
+    if (header.startsWith("RIFF") && header.mid(8, 4) == "WEBP")
+        return "webp";
+    if (header.startsWith("BM"))
+        return "bmp";
+    if (header.startsWith(QByteArray("II*\0", 4)) || header.startsWith(QByteArray("MM\0*", 4)))
+        return "tiff";
+    // An uncompressed true colour tga starts with the same four bytes as a cursor,
+    // so only claim the file if its directory actually fits
+    if (header.startsWith(QByteArray("\0\0\1\0", 4)) || header.startsWith(QByteArray("\0\0\2\0", 4)))
+    {
+        const auto *data = reinterpret_cast<const uchar*>(header.constData());
+        if (header.size() >= 22)
+        {
+            const int entryCount = qFromLittleEndian<quint16>(data + 4);
+            const qint64 imageSize = qFromLittleEndian<quint32>(data + 14);
+            const qint64 imageOffset = qFromLittleEndian<quint32>(data + 18);
+            const bool fitsInFile = device->isSequential() || imageOffset + imageSize <= device->size();
+            if (entryCount > 0 && data[9] == 0 && imageSize > 0 && imageOffset >= 6 + entryCount*16 && fitsInFile)
+                return data[2] == 1 ? "ico" : "cur";
+        }
+        return QByteArray();
+    }
+    if (header.startsWith("\x8aMNG\r\n\x1a\n"))
+        return "mng";
+    if (header.startsWith("8BPS"))
+        return "psd";
+    if (header.startsWith("DDS "))
+        return "dds";
+    if (header.startsWith("icns"))
+        return "icns";
+    if (header.startsWith("qoif"))
+        return "qoi";
+    if (header.startsWith("gimp xcf"))
+        return "xcf";
+    if (header.startsWith("\x76\x2f\x31\x01"))
+        return "exr";
+    if (header.startsWith("#?RADIANCE") || header.startsWith("#?RGBE"))
+        return "hdr";
+    if (header.startsWith("/* XPM */"))
+        return "xpm";
+    if (header.startsWith(QByteArray("\0\0\0\x0cjP  \r\n\x87\n", 12)))
+        return "jp2";
+    if (header.startsWith("\xff\x0a") || header.startsWith(QByteArray("\0\0\0\x0cJXL \r\n\x87\n", 12)))
+        return "jxl";
+
+    // ISO base media files say what they contain in the brand of their ftyp box
+    if (header.mid(4, 4) == "ftyp")
+    {
+        const QByteArray brand = header.mid(8, 4);
+        if (brand == "avif" || brand == "avis")
+            return "avif";
+        if (brand == "heic" || brand == "heix" || brand == "mif1" || brand == "msf1")
+            return "heif";
+    }
+
+    // Netpbm formats are P1 to P6 followed by whitespace
+    if (header.size() > 2 && header.at(0) == 'P' && QByteArray(" \t\r\n").contains(header.at(2)))
+    {
+        switch (header.at(1)) {
+        case '1':
+        case '4':
+            return "pbm";
+        case '2':
+        case '5':
+            return "pgm";
+        case '3':
+        case '6':
+            return "ppm";
+        }
+    }
+
+    if (header.contains("<svg"))
+        return "svg";
+
+    // Formats like tga and xbm have no reliable signature, so Qt has to look at them
+    return QByteArray();
 }
 
 void QVImageCore::loadPixmap(const ReadData &readData, bool fromCache)
 {
+    Q_UNUSED(fromCache)
+
     // Do this first so we can keep folder info even when loading errored files
     currentFileDetails.fileInfo = readData.fileInfo;
     updateFolderInfo();
@@ -152,10 +571,15 @@ void QVImageCore::loadPixmap(const ReadData &readData, bool fromCache)
     // Reset file change rate timer
     fileChangeRateTimer->start();
 
-    if (readData.pixmap.isNull())
+    if (readData.image.isNull())
         return;
 
-    loadedPixmap = matchCurrentRotation(readData.pixmap);
+    // This is the only place the compact image is converted to something the screen can draw
+    PerformanceMonitor::Timer uploadTimer("upload");
+    deepScaleWatcher.setFuture(QFuture<QImage>());
+    loadedDeepImage = readData.deepImage;
+    loadedPixmap = QPixmap::fromImage(matchCurrentRotation(readData.image));
+    uploadTimer.finish();
 
     // Set file details
     currentFileDetails.isPixmapLoaded = true;
@@ -167,24 +591,26 @@ void QVImageCore::loadPixmap(const ReadData &readData, bool fromCache)
         currentFileDetails.baseImageSize = currentFileDetails.loadedPixmapSize;
     }
 
-    // If this image isnt originally from the cache, add it to the cache
-    if (!fromCache)
-        addToCache(readData);
-
-    // Animation detection
+    // Animation detection happened while decoding, so still images never open the file again
     loadedMovie.stop();
-    loadedMovie.setFileName(currentFileDetails.fileInfo.absoluteFilePath());
+    currentFileDetails.isMovieLoaded = false;
+    if (readData.isAnimated)
+    {
+        loadedMovie.setFileName(currentFileDetails.fileInfo.absoluteFilePath());
 
-    // APNG workaround
-    if (loadedMovie.format() == "png")
-        loadedMovie.setFormat("apng");
+        // Use the format that was already detected, which also tells apng apart from png
+        const QByteArray format = detectFormat(currentFileDetails.fileInfo.absoluteFilePath());
+        if (!format.isEmpty())
+            loadedMovie.setFormat(format);
 
-    currentFileDetails.isMovieLoaded = loadedMovie.isValid() && loadedMovie.frameCount() != 1;
+        // Animations with an unknown frame count still have to be checked
+        currentFileDetails.isMovieLoaded = loadedMovie.isValid() && (readData.frameCount > 1 || loadedMovie.frameCount() != 1);
+    }
 
     if (currentFileDetails.isMovieLoaded)
         loadedMovie.start();
-    else if (auto device = loadedMovie.device())
-        device->close();
+    else
+        loadedMovie.setFileName("");
 
     emit fileChanged();
 
@@ -194,11 +620,14 @@ void QVImageCore::loadPixmap(const ReadData &readData, bool fromCache)
 void QVImageCore::closeImage()
 {
     loadedPixmap = QPixmap();
+    deepScaleWatcher.setFuture(QFuture<QImage>());
+    loadedDeepImage = QImage();
     loadedMovie.stop();
     loadedMovie.setFileName("");
     currentFileDetails = {
         QFileInfo(),
         currentFileDetails.folderFileInfoList,
+        currentFileDetails.folderListGeneration,
         currentFileDetails.loadedIndexInFolder,
         false,
         false,
@@ -212,9 +641,71 @@ void QVImageCore::closeImage()
 
 void QVImageCore::updateFolderInfo()
 {
+    QString archivePath;
+    QString memberName;
+    if (ArchiveReader::splitPath(currentFileDetails.fileInfo.absoluteFilePath(), archivePath, memberName))
+    {
+        // Images inside an archive are browsed like a folder, the listing only changes with the archive
+        if (archivePath != lastArchivePath)
+        {
+            lastArchivePath = archivePath;
+            archiveFileInfoList = getArchiveFileInfoList(archivePath);
+            archiveListGeneration = ++lastListGeneration;
+        }
+
+        const QString filePath = currentFileDetails.fileInfo.absoluteFilePath();
+        currentFileDetails.folderFileInfoList = archiveFileInfoList;
+        currentFileDetails.folderListGeneration = archiveListGeneration;
+        currentFileDetails.loadedIndexInFolder = -1;
+        for (int i = 0; i < archiveFileInfoList.size(); i++)
+        {
+            if (archiveFileInfoList.at(i).absoluteFilePath() == filePath)
+            {
+                currentFileDetails.loadedIndexInFolder = i;
+                break;
+            }
+        }
+        return;
+    }
+
     if (!currentFileDetails.fileInfo.isFile())
         return;
 
+    if (!playlist.isEmpty())
+    {
+        const int playlistIndex = playlistIndexes.value(currentFileDetails.fileInfo.absoluteFilePath(), -1);
+        if (playlistIndex != -1)
+        {
+            currentFileDetails.folderFileInfoList = playlist;
+            currentFileDetails.folderListGeneration = playlistGeneration;
+            currentFileDetails.loadedIndexInFolder = playlistIndex;
+            return;
+        }
+
+        // A file from outside the playlist was opened, so go back to browsing its folder
+        playlist.clear();
+        playlistIndexes.clear();
+    }
+
+    if (isRecursiveBrowsingEnabled)
+    {
+        updateRecursiveFolderInfo();
+        return;
+    }
+
+    // The last listing is reused while the folder can't have changed, which keeps jumping around huge folders cheap.
+    // Sorting by time or size also depends on changes to the files themselves, so those are always listed again.
+    const QString folderPath = currentFileDetails.fileInfo.absolutePath();
+    const QDateTime folderModified = QFileInfo(folderPath).lastModified();
+    if (folderPath == listedFolderPath && folderModified == listedFolderModified && folderModified.msecsTo(listedFolderTime) > 2000 &&
+            sortMode == listedSortMode && sortDescending == listedSortDescending && sortMode != 1 && sortMode != 2)
+    {
+        currentFileDetails.folderFileInfoList = listedFileInfoList;
+        currentFileDetails.folderListGeneration = listedGeneration;
+        currentFileDetails.loadedIndexInFolder = listedIndexes.value(currentFileDetails.fileInfo.absoluteFilePath(), -1);
+        return;
+    }
+
     QPair<QString, uint> dirInfo = {currentFileDetails.fileInfo.absoluteDir().path(),
                                     currentFileDetails.fileInfo.dir().count()};
     // If the current folder changed since the last image, assign a new seed for random sorting
@@ -267,28 +758,339 @@ void QVImageCore::updateFolderInfo()
         std::shuffle(currentFileDetails.folderFileInfoList.begin(), currentFileDetails.folderFileInfoList.end(), std::default_random_engine(randomSortSeed));
     }
 
+    // Remember the listing, a folder changed within the last two seconds might still change without its time moving
+    listedFolderPath = folderPath;
+    listedFolderModified = folderModified;
+    listedFolderTime = QDateTime::currentDateTime();
+    listedSortMode = sortMode;
+    listedSortDescending = sortDescending;
+    listedFileInfoList = currentFileDetails.folderFileInfoList;
+    listedGeneration = ++lastListGeneration;
+    currentFileDetails.folderListGeneration = listedGeneration;
+    listedIndexes.clear();
+    listedIndexes.reserve(listedFileInfoList.size());
+    for (int i = 0; i < listedFileInfoList.size(); i++)
+        listedIndexes.insert(listedFileInfoList.at(i).absoluteFilePath(), i);
+
     // Set current file index variable
-    currentFileDetails.loadedIndexInFolder = currentFileDetails.folderFileInfoList.indexOf(currentFileDetails.fileInfo);
+    currentFileDetails.loadedIndexInFolder = listedIndexes.value(currentFileDetails.fileInfo.absoluteFilePath(), -1);
+}
+
+void QVImageCore::clearFolderListing()
+{
+    listedFolderPath.clear();
+    listedFileInfoList.clear();
+    listedIndexes.clear();
+}
+
+QList<int> QVImageCore::findFilesByPrefix(const QString &prefix, int maxCount)
+{
+    // Built the first time the current list is searched, and kept for as long as that list is
+    const QFileInfoList &fileInfoList = currentFileDetails.folderFileInfoList;
+    if (prefixIndexSource.size() != fileInfoList.size() || prefixIndexSource.constBegin() != fileInfoList.constBegin())
+    {
+        prefixIndexSource = fileInfoList;
+        prefixIndex.clear();
+        prefixIndex.reserve(fileInfoList.size());
+        for (int i = 0; i < fileInfoList.size(); i++)
+            prefixIndex.append({fileInfoList.at(i).fileName().toCaseFolded(), i});
+        std::sort(prefixIndex.begin(), prefixIndex.end());
+    }
+
+    const QString foldedPrefix = prefix.toCaseFolded();
+    auto it = std::lower_bound(prefixIndex.constBegin(), prefixIndex.constEnd(), foldedPrefix,
+                               [](const QPair<QString, int> &entry, const QString &value) { return entry.first < value; });
+
+    QList<int> indexes;
+    for (; it != prefixIndex.constEnd() && indexes.size() < maxCount && it->first.startsWith(foldedPrefix); ++it)
+        indexes.append(it->second);
+    return indexes;
+}
+
+QFileInfoList QVImageCore::getArchiveFileInfoList(const QString &archivePath)
+{
+    // Only members that look like supported images, in natural order like pages of a book
+    QSet<QString> suffixes;
+    const auto &filterList = qvApp->getFilterList();
+    for (const auto &filter : filterList)
+        suffixes.insert(filter.mid(2).toLower());
+
+    QStringList memberNames;
+    const QStringList allMemberNames = ArchiveReader::getMemberNames(archivePath);
+    for (const auto &memberName : allMemberNames)
+    {
+        if (suffixes.contains(QFileInfo(memberName).suffix().toLower()))
+            memberNames.append(memberName);
+    }
+
+    std::sort(memberNames.begin(), memberNames.end(), [this](const QString &name1, const QString &name2)
+    {
+        if (sortDescending)
+            return collator.compare(name1, name2) > 0;
+        else
+            return collator.compare(name1, name2) < 0;
+    });
+
+    QFileInfoList fileInfoList;
+    fileInfoList.reserve(memberNames.size());
+    for (const auto &memberName : qAsConst(memberNames))
+        fileInfoList.append(QFileInfo(archivePath + '/' + memberName));
+
+    return fileInfoList;
+}
+
+void QVImageCore::updateRecursiveFolderInfo()
+{
+    const QString filePath = currentFileDetails.fileInfo.absoluteFilePath();
+
+    auto findFile = [&filePath, this]{
+        if (recursiveIndexes.isEmpty() && !recursiveFileInfoList.isEmpty())
+        {
+            recursiveIndexes.reserve(recursiveFileInfoList.size());
+            for (int i = 0; i < recursiveFileInfoList.size(); i++)
+                recursiveIndexes.insert(recursiveFileInfoList.at(i).absoluteFilePath(), i);
+        }
+        return recursiveIndexes.value(filePath, -1);
+    };
+
+    // Moving between subfolders keeps the current walk, anything else starts over from the file's folder
+    QString rootPrefix = recursiveRootPath;
+    if (!rootPrefix.endsWith('/'))
+        rootPrefix += '/';
+
+    int index = -1;
+    if (!recursiveRootPath.isEmpty() && filePath.startsWith(rootPrefix))
+        index = findFile();
+
+    if (index == -1)
+    {
+        startDirectoryWalk(currentFileDetails.fileInfo.absolutePath());
+        index = findFile();
+    }
+
+    currentFileDetails.folderFileInfoList = recursiveFileInfoList;
+    currentFileDetails.folderListGeneration = recursiveListGeneration;
+    currentFileDetails.loadedIndexInFolder = index;
+}
+
+void QVImageCore::startDirectoryWalk(const QString &rootPath)
+{
+    stopDirectoryWalk();
+
+    recursiveRootPath = rootPath;
+    recursiveRandomEngine.seed(std::chrono::system_clock::now().time_since_epoch().count());
+
+    // The root folder is listed right away so there is something to navigate before the walk finds anything
+    recursiveFileInfoList = QDir(rootPath).entryInfoList(qvApp->getFilterList(), QDir::Files);
+    sortRecursiveFileInfoList();
+
+    isWalkCancelled = std::make_shared<std::atomic<bool>>(false);
+    auto *directoryWalker = new DirectoryWalker(rootPath, qvApp->getFilterList(), sortMode == 1 || sortMode == 2, isWalkCancelled);
+    connect(directoryWalker, &DirectoryWalker::entriesFound, this, [this, isCancelled = isWalkCancelled](const QFileInfoList &entries){
+        // Batches from a walk that was replaced may still be queued
+        if (*isCancelled)
+            return;
+
+        addRecursiveEntries(entries);
+    });
+    directoryWalker->start();
+}
+
+void QVImageCore::stopDirectoryWalk()
+{
+    if (isWalkCancelled)
+        *isWalkCancelled = true;
+
+    isWalkCancelled.reset();
+    recursiveRootPath.clear();
+    recursiveFileInfoList.clear();
+    recursiveIndexes.clear();
+}
+
+void QVImageCore::addRecursiveEntries(const QFileInfoList &entries)
+{
+    // The current file is followed through the batch, so the whole list never has to be searched for it
+    int currentIndex = currentFileDetails.loadedIndexInFolder;
+    if (currentIndex < 0 || currentIndex >= recursiveFileInfoList.size() ||
+            recursiveFileInfoList.at(currentIndex).absoluteFilePath() != currentFileDetails.fileInfo.absoluteFilePath())
+        currentIndex = -1;
+
+    const int oldSize = recursiveFileInfoList.size();
+    recursiveFileInfoList.reserve(oldSize + entries.size());
+
+    if (sortMode == 4) // Random sorting
+    {
+        // Each new file swaps with a random earlier one, which keeps the whole list uniformly shuffled
+        for (const auto &entry : entries)
+        {
+            const int newIndex = recursiveFileInfoList.size();
+            recursiveFileInfoList.append(entry);
+
+            std::uniform_int_distribution<int> distribution(0, newIndex);
+            const int swapIndex = distribution(recursiveRandomEngine);
+            std::swap(recursiveFileInfoList[newIndex], recursiveFileInfoList[swapIndex]);
+            if (swapIndex == currentIndex)
+                currentIndex = newIndex;
+        }
+    }
+    else
+    {
+        // Merge each sorted batch in instead of sorting everything found so far again
+        auto lessThan = [this](const QFileInfo &file1, const QFileInfo &file2)
+        {
+            return isFileSortedBefore(file1, file2);
+        };
+
+        recursiveFileInfoList.append(entries);
+        std::sort(recursiveFileInfoList.begin() + oldSize, recursiveFileInfoList.end(), lessThan);
+
+        // Everything new that sorts before the current file pushes it along
+        if (currentIndex != -1)
+        {
+            const QFileInfo currentFileInfo = recursiveFileInfoList.at(currentIndex);
+            currentIndex += std::lower_bound(recursiveFileInfoList.begin() + oldSize, recursiveFileInfoList.end(),
+                                             currentFileInfo, lessThan) - (recursiveFileInfoList.begin() + oldSize);
+        }
+
+        std::inplace_merge(recursiveFileInfoList.begin(), recursiveFileInfoList.begin() + oldSize, recursiveFileInfoList.end(), lessThan);
+    }
+
+    recursiveIndexes.clear();
+    recursiveListGeneration = ++lastListGeneration;
+
+    // Files in other folders can be navigated to and preloaded as soon as they are found
+    if (!playlist.isEmpty() || !currentFileDetails.fileInfo.isFile())
+        return;
+
+    if (currentIndex == -1)
+    {
+        updateFolderInfo();
+    }
+    else
+    {
+        currentFileDetails.folderFileInfoList = recursiveFileInfoList;
+        currentFileDetails.folderListGeneration = recursiveListGeneration;
+        currentFileDetails.loadedIndexInFolder = currentIndex;
+    }
+
+    if (currentFileDetails.isPixmapLoaded)
+        requestCaching();
+
+    emit folderListChanged();
+}
+
+void QVImageCore::sortRecursiveFileInfoList()
+{
+    recursiveIndexes.clear();
+    recursiveListGeneration = ++lastListGeneration;
+
+    if (sortMode == 4) // Random sorting
+    {
+        std::shuffle(recursiveFileInfoList.begin(), recursiveFileInfoList.end(), recursiveRandomEngine);
+        return;
+    }
+
+    std::stable_sort(recursiveFileInfoList.begin(), recursiveFileInfoList.end(),
+                     [this](const QFileInfo &file1, const QFileInfo &file2)
+    {
+        return isFileSortedBefore(file1, file2);
+    });
+}
+
+bool QVImageCore::isFileSortedBefore(const QFileInfo &file1, const QFileInfo &file2) const
+{
+    // Same orders as the folder sorting above, but ties compare whole paths so each subfolder stays together
+    const QFileInfo &first = sortDescending ? file2 : file1;
+    const QFileInfo &second = sortDescending ? file1 : file2;
+
+    switch (sortMode) {
+    case 1: {
+        if (first.lastModified() != second.lastModified())
+            return first.lastModified() > second.lastModified();
+        break;
+    }
+    case 2: {
+        if (first.size() != second.size())
+            return first.size() > second.size();
+        break;
+    }
+    case 3: {
+        const int result = first.suffix().compare(second.suffix());
+        if (result != 0)
+            return result < 0;
+        break;
+    }
+    }
+
+    return collator.compare(first.absoluteFilePath(), second.absoluteFilePath()) < 0;
 }
 
 void QVImageCore::requestCaching()
 {
+    auto &imageManager = qvApp->getImageManager();
+    const QString currentFilePath = currentFileDetails.fileInfo.absoluteFilePath();
+
     if (preloadingMode == 0)
     {
-        QPixmapCache::clear();
+        imageManager.requestPreloads(this, currentFilePath, {});
         return;
     }
 
     int preloadingDistance = 1;
+    int encodedPreloadingDistance = 0;
 
+    // How far ahead depends on how big the images in this folder are and how long they take to decode.
+    // Past the decoded neighbours, files are only read into memory so they can be decoded on approach.
     if (preloadingMode > 1)
-        preloadingDistance = 4;
+    {
+        preloadingDistance = imageManager.getPreloadingDistance();
+        encodedPreloadingDistance = imageManager.getEncodedPreloadingDistance();
 
-    QStringList filesToPreload;
-    for (int i = currentFileDetails.loadedIndexInFolder-preloadingDistance; i <= currentFileDetails.loadedIndexInFolder+preloadingDistance; i++)
+        // A slideshow knows when each file is due, so it decodes just far enough ahead to have every slide ready in time
+        if (slideshowDirection != 0)
+            preloadingDistance = imageManager.getSlideshowPreloadingDistance(slideshowInterval);
+    }
+
+    // Split the window between both sides, giving most of it to the way the user is heading.
+    // A running slideshow only ever goes one way, and paging faster leans further ahead.
+    int direction = slideshowDirection != 0 ? slideshowDirection : navigationDirection;
+    if (direction == 0)
+        direction = 1;
+
+    const int windowSize = (preloadingDistance+encodedPreloadingDistance)*2;
+    double aheadShare = 0.5;
+    if (slideshowDirection != 0)
+        aheadShare = 0.9;
+    else if (navigationDirection != 0)
+        aheadShare = 0.7 + 0.2*qMin(1.0, navigationVelocity/4);
+
+    int aheadDistance = qMax(1, qRound(windowSize*aheadShare));
+    int behindDistance = qMax(1, windowSize-aheadDistance);
+
+    // Going further than all the way around a looping folder would only request the same files again
+    const int otherFileCount = currentFileDetails.folderFileInfoList.length()-1;
+    aheadDistance = qMin(aheadDistance, otherFileCount);
+    behindDistance = qMin(behindDistance, otherFileCount-aheadDistance);
+
+    // Nearest files first, since they are decoded in the order they are requested.
+    // A slideshow won't go back, so everything ahead comes first and gets all the decoding.
+    QVector<int> indexes;
+    for (int offset = 1; offset <= qMax(aheadDistance, behindDistance); offset++)
+    {
+        if (offset <= aheadDistance)
+            indexes << currentFileDetails.loadedIndexInFolder+offset*direction;
+        if (offset <= behindDistance && slideshowDirection == 0)
+            indexes << currentFileDetails.loadedIndexInFolder-offset*direction;
+    }
+    if (slideshowDirection != 0)
     {
-        int index = i;
+        for (int offset = 1; offset <= behindDistance; offset++)
+            indexes << currentFileDetails.loadedIndexInFolder-offset*direction;
+    }
 
+    QStringList filesToPreload;
+    for (int index : qAsConst(indexes))
+    {
         // Don't try to cache the currently loaded image
         if (index == currentFileDetails.loadedIndexInFolder)
             continue;
@@ -306,47 +1108,32 @@ void QVImageCore::requestCaching()
         if (index > currentFileDetails.folderFileInfoList.length()-1 || index < 0 || currentFileDetails.folderFileInfoList.isEmpty())
             continue;
 
-        QString filePath = currentFileDetails.folderFileInfoList[index].absoluteFilePath();
-        filesToPreload.append(filePath);
-
-        requestCachingFile(filePath);
+        filesToPreload.append(currentFileDetails.folderFileInfoList[index].absoluteFilePath());
     }
-    lastFilesPreloaded = filesToPreload;
 
+    imageManager.requestPreloads(this, currentFilePath, filesToPreload, slideshowDirection != 0 ? preloadingDistance : preloadingDistance*2);
 }
 
-void QVImageCore::requestCachingFile(const QString &filePath)
+void QVImageCore::recordNavigation(int direction)
 {
-    //check if image is already loaded or requested
-    if (QPixmapCache::find(filePath, nullptr) || lastFilesPreloaded.contains(filePath))
-        return;
+    // Steps per second, smoothed, and starting over whenever the user turns around
+    const qint64 interval = navigationTimer.isValid() ? navigationTimer.restart() : -1;
+    if (!navigationTimer.isValid())
+        navigationTimer.start();
 
-    //check if too big for caching
-    //This size check is probably inefficient and could be replaced
-    QImageReader newImageReader(filePath);
-    QTransform transform;
-    transform.rotate(currentRotation);
-    if (((newImageReader.size().width()*newImageReader.size().height()*32)/8)/1000 > QPixmapCache::cacheLimit()/2)
-        return;
+    if (direction != navigationDirection || interval < 0 || !navigationIdleTimer->isActive())
+        navigationVelocity = 0;
+    else
+        navigationVelocity = navigationVelocity*0.5 + (1000.0/qMax<qint64>(1, interval))*0.5;
 
-    auto *cacheFutureWatcher = new QFutureWatcher<ReadData>();
-    connect(cacheFutureWatcher, &QFutureWatcher<ReadData>::finished, this, [cacheFutureWatcher, this](){
-        addToCache(cacheFutureWatcher->result());
-        cacheFutureWatcher->deleteLater();
-    });
-    cacheFutureWatcher->setFuture(QtConcurrent::run(this, &QVImageCore::readFile, filePath, true));
+    navigationDirection = direction;
+    navigationIdleTimer->start();
 }
 
-void QVImageCore::addToCache(const ReadData &readData)
+void QVImageCore::setSlideshowDirection(int direction, int interval)
 {
-    if (readData.pixmap.isNull())
-        return;
-
-    QPixmapCache::insert(readData.fileInfo.absoluteFilePath(), readData.pixmap);
-
-    auto *size = new qint64(readData.fileInfo.size());
-    qvApp->setPreviouslyRecordedFileSize(readData.fileInfo.absoluteFilePath(), size);
-    qvApp->setPreviouslyRecordedImageSize(readData.fileInfo.absoluteFilePath(), new QSize(readData.size));
+    slideshowDirection = direction;
+    slideshowInterval = interval;
 }
 
 void QVImageCore::jumpToNextFrame()
@@ -369,6 +1156,8 @@ void QVImageCore::setSpeed(int desiredSpeed)
 
 void QVImageCore::rotateImage(int rotation)
 {
+        PerformanceMonitor::Timer rotateTimer("rotate");
+
         currentRotation += rotation;
 
         // normalize between 360 and 0
@@ -421,9 +1210,16 @@ QPixmap QVImageCore::scaleExpensively(const QSize desiredSize, const ScaleMode m
     if (!currentFileDetails.isPixmapLoaded)
         return QPixmap();
 
+    PerformanceMonitor::Timer scaleTimer("expensive scale");
+
     QSize size = QSize(loadedPixmap.width(), loadedPixmap.height());
     size.scale(desiredSize, Qt::KeepAspectRatio);
 
+    // Deep images are shown scaled from their 8-bit copy right away, and the original is filtered
+    // at full precision on a worker to replace it, only reduced to the display's 8 bits afterwards
+    if (!currentFileDetails.isMovieLoaded && !loadedDeepImage.isNull())
+        deepScaleWatcher.setFuture(QtConcurrent::run(&QVImageCore::scaleImage, loadedDeepImage, desiredSize, mode, currentRotation));
+
     QPixmap relevantPixmap;
     if (!currentFileDetails.isMovieLoaded)
     {
@@ -456,6 +1252,43 @@ QPixmap QVImageCore::scaleExpensively(const QSize desiredSize, const ScaleMode m
     return relevantPixmap;
 }
 
+QImage QVImageCore::scaleImage(const QImage &image, const QSize desiredSize, const ScaleMode mode, int rotation)
+{
+    // Scaling happens before rotating, so the rotation only has to move the scaled pixels
+    const bool isTransposed = rotation % 180 != 0;
+    QSize size = isTransposed ? image.size().transposed() : image.size();
+    size.scale(desiredSize, Qt::KeepAspectRatio);
+    if (isTransposed)
+        size.transpose();
+
+    QImage relevantImage;
+    switch (mode) {
+    case ScaleMode::normal:
+    {
+        relevantImage = image.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        break;
+    }
+    case ScaleMode::width:
+    {
+        relevantImage = isTransposed ? image.scaledToHeight(desiredSize.width(), Qt::SmoothTransformation)
+                                     : image.scaledToWidth(desiredSize.width(), Qt::SmoothTransformation);
+        break;
+    }
+    case ScaleMode::height:
+    {
+        relevantImage = isTransposed ? image.scaledToWidth(desiredSize.height(), Qt::SmoothTransformation)
+                                     : image.scaledToHeight(desiredSize.height(), Qt::SmoothTransformation);
+        break;
+    }
+    }
+
+    if (!rotation)
+        return relevantImage;
+
+    QTransform transform;
+    transform.rotate(rotation);
+    return relevantImage.transformed(transform);
+}
 
 void QVImageCore::settingsUpdated()
 {
@@ -466,18 +1299,6 @@ void QVImageCore::settingsUpdated()
 
     //preloading mode
     preloadingMode = settingsManager.getInteger("preloadingmode");
-    switch (preloadingMode) {
-    case 1:
-    {
-        QPixmapCache::setCacheLimit(51200);
-        break;
-    }
-    case 2:
-    {
-        QPixmapCache::setCacheLimit(204800);
-        break;
-    }
-    }
 
     //sort mode
     sortMode = settingsManager.getInteger("sortmode");
@@ -485,6 +1306,16 @@ void QVImageCore::settingsUpdated()
     //sort ascending
     sortDescending = settingsManager.getBoolean("sortdescending");
 
+    //list archives again in case the sort order changed
+    lastArchivePath.clear();
+
+    //recursive browsing
+    isRecursiveBrowsingEnabled = settingsManager.getBoolean("recursivebrowsing");
+    if (!isRecursiveBrowsingEnabled)
+        stopDirectoryWalk();
+    else
+        sortRecursiveFileInfoList();
+
     //update folder info to re-sort
     updateFolderInfo();
 }
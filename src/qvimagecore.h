@@ -8,7 +8,14 @@
 #include <QFileInfo>
 #include <QFutureWatcher>
 #include <QTimer>
-#include <QCache>
+#include <QElapsedTimer>
+#include <QCollator>
+#include <QDateTime>
+#include <QHash>
+#include <QVector>
+#include <atomic>
+#include <memory>
+#include <random>
 
 class QVImageCore : public QObject
 {
@@ -27,6 +34,8 @@ public:
     {
         QFileInfo fileInfo;
         QFileInfoList folderFileInfoList;
+        // Changes whenever the list does, so it can be told apart from the last one without comparing them
+        quint64 folderListGeneration = 0;
         int loadedIndexInFolder = -1;
         bool isLoadRequested = false;
         bool isPixmapLoaded = false;
@@ -37,21 +46,43 @@ public:
 
     struct ReadData
     {
-        QPixmap pixmap;
+        // Kept in the most compact format that shows the same pixels, and only uploaded when displayed
+        QImage image;
+        // Full precision original of an image with more than 8 bits per channel, only kept for high quality scaling
+        QImage deepImage;
         QFileInfo fileInfo;
         QSize size;
+        int errorNum = 0;
+        QString errorString;
+        int frameCount = 1;
+        bool isAnimated = false;
+        qint64 decodeTime = 0;
+        // The setting the image was converted under, in case it changes while the read is running
+        bool isColorManaged = false;
+        // Left undecoded because it would have cost more than the preload was allowed to take
+        bool isSkipped = false;
     };
 
     explicit QVImageCore(QObject *parent = nullptr);
+    ~QVImageCore() override;
 
     void loadFile(const QString &fileName);
-    ReadData readFile(const QString &fileName, bool forCache);
+    void loadPlaylist(const QStringList &fileNames);
+    void appendToPlaylist(const QStringList &fileNames);
+    static ReadData readFile(const QString &fileName, int largestDimension, bool isColorManaged, const QByteArray &encodedData = QByteArray(), qint64 maxCost = -1, bool isDeepImageKept = false);
+    static QByteArray readEncodedFile(const QString &fileName);
+    static QImage compactImage(const QImage &image);
+    static void convertToDisplayColorSpace(QImage &image);
+    static QByteArray detectFormat(const QString &fileName);
+    static QByteArray detectFormat(QIODevice *device);
     void loadPixmap(const ReadData &readData, bool fromCache);
     void closeImage();
     void updateFolderInfo();
+    void clearFolderListing();
+    QList<int> findFilesByPrefix(const QString &prefix, int maxCount);
     void requestCaching();
-    void requestCachingFile(const QString &filePath);
-    void addToCache(const ReadData &readImageAndFileInfo);
+    void recordNavigation(int direction);
+    void setSlideshowDirection(int direction, int interval = 0);
 
     void settingsUpdated();
 
@@ -65,12 +96,14 @@ public:
 
     QPixmap scaleExpensively(const int desiredWidth, const int desiredHeight, const ScaleMode mode = ScaleMode::normal);
     QPixmap scaleExpensively(const QSize desiredSize, const ScaleMode mode = ScaleMode::normal);
+    static QImage scaleImage(const QImage &image, const QSize desiredSize, const ScaleMode mode = ScaleMode::normal, int rotation = 0);
 
     //returned const reference is read-only
     const QPixmap& getLoadedPixmap() const {return loadedPixmap; }
     const QMovie& getLoadedMovie() const {return loadedMovie; }
     const FileDetails& getCurrentFileDetails() const {return currentFileDetails; }
     int getCurrentRotation() const {return currentRotation; }
+    bool getIsPlaylistActive() const {return !playlist.isEmpty(); }
 
 signals:
     void animatedFrameChanged(QRect rect);
@@ -79,10 +112,27 @@ signals:
 
     void fileChanged();
 
+    void folderListChanged();
+
+    void deepScaleFinished(const QPixmap &scaledPixmap);
+
     void readError(int errorNum, const QString &errorString, const QString &fileName);
 
+protected:
+    void addPlaylistEntries(const QStringList &fileNames);
+    QFileInfoList getArchiveFileInfoList(const QString &archivePath);
+    void updateRecursiveFolderInfo();
+    void startDirectoryWalk(const QString &rootPath);
+    void stopDirectoryWalk();
+    void addRecursiveEntries(const QFileInfoList &entries);
+    void sortRecursiveFileInfoList();
+    bool isFileSortedBefore(const QFileInfo &file1, const QFileInfo &file2) const;
+
 private:
     QPixmap loadedPixmap;
+    // Unrotated full precision original of a deep image, scaled on a worker before losing its extra precision
+    QImage loadedDeepImage;
+    QFutureWatcher<QImage> deepScaleWatcher;
     QMovie loadedMovie;
 
     FileDetails currentFileDetails;
@@ -94,15 +144,57 @@ private:
     int preloadingMode;
     int sortMode;
     bool sortDescending;
+    bool isRecursiveBrowsingEnabled;
+
+    // Files opened together are browsed in the order given instead of by folder
+    QFileInfoList playlist;
+    QHash<QString, int> playlistIndexes;
+    quint64 playlistGeneration;
+
+    // Members of the archive that was browsed last
+    QString lastArchivePath;
+    QFileInfoList archiveFileInfoList;
+    quint64 archiveListGeneration;
+
+    // The folder being walked for recursive browsing and everything found in it so far
+    QString recursiveRootPath;
+    QFileInfoList recursiveFileInfoList;
+    // Each file's position in the list above, built when it's first needed after the list changes
+    QHash<QString, int> recursiveIndexes;
+    quint64 recursiveListGeneration;
+    std::shared_ptr<std::atomic<bool>> isWalkCancelled;
+    std::default_random_engine recursiveRandomEngine;
+    QCollator collator;
+
+    // The last folder listed the normal way, with each file's position in it
+    QString listedFolderPath;
+    QDateTime listedFolderModified;
+    QDateTime listedFolderTime;
+    int listedSortMode;
+    bool listedSortDescending;
+    QFileInfoList listedFileInfoList;
+    QHash<QString, int> listedIndexes;
+    quint64 listedGeneration;
+
+    // Each of the lists above takes a new number from here whenever it changes
+    quint64 lastListGeneration;
+
+    // File names of the current list in sorted order, for finding files by what they start with
+    QFileInfoList prefixIndexSource;
+    QVector<QPair<QString, int>> prefixIndex;
 
     QPair<QString, uint> lastDirInfo;
     unsigned randomSortSeed;
 
-    QStringList lastFilesPreloaded;
-
     QTimer *fileChangeRateTimer;
 
-    int largestDimension;
+    // Where the user has been heading lately, so preloading can favour that side
+    int navigationDirection;
+    double navigationVelocity;
+    int slideshowDirection;
+    int slideshowInterval;
+    QElapsedTimer navigationTimer;
+    QTimer *navigationIdleTimer;
 };
 
 #endif // QVIMAGECORE_H
@@ -144,6 +144,8 @@ void QVOptionsDialog::syncSettings(bool defaults, bool makeConnections)
     syncCheckbox(ui->menubarCheckbox, "menubarenabled", defaults, makeConnections);
     // fullscreendetails
     syncCheckbox(ui->detailsInFullscreen, "fullscreendetails", defaults, makeConnections);
+    // performanceoverlay
+    syncCheckbox(ui->performanceOverlayCheckbox, "performanceoverlay", defaults, makeConnections);
     // filteringenabled
     syncCheckbox(ui->filteringCheckbox, "filteringenabled", defaults, makeConnections);
     // scalingenabled
@@ -164,6 +166,8 @@ void QVOptionsDialog::syncSettings(bool defaults, bool makeConnections)
     syncComboBox(ui->cropModeComboBox, "cropmode", defaults, makeConnections);
     // pastactualsizeenabled
     syncCheckbox(ui->pastActualSizeCheckbox, "pastactualsizeenabled", defaults, makeConnections);
+    // colormanagement
+    syncCheckbox(ui->colorManagementCheckbox, "colormanagement", defaults, makeConnections);
     // language
     syncComboBoxData(ui->langComboBox, "language", defaults, makeConnections);
     // sortmode
@@ -172,8 +176,12 @@ void QVOptionsDialog::syncSettings(bool defaults, bool makeConnections)
     syncRadioButtons({ui->descendingRadioButton0, ui->descendingRadioButton1}, "sortdescending", defaults, makeConnections);
     // preloadingmode
     syncComboBox(ui->preloadingComboBox, "preloadingmode", defaults, makeConnections);
+    // preloadingbudget
+    syncSpinBox(ui->preloadingBudgetSpinBox, "preloadingbudget", defaults, makeConnections);
     // loopfolders
     syncCheckbox(ui->loopFoldersCheckbox, "loopfoldersenabled", defaults, makeConnections);
+    // recursivebrowsing
+    syncCheckbox(ui->recursiveBrowsingCheckbox, "recursivebrowsing", defaults, makeConnections);
     // slideshowreversed
     syncComboBox(ui->slideshowDirectionComboBox, "slideshowreversed", defaults, makeConnections);
     // slideshowtimer
@@ -186,6 +194,8 @@ void QVOptionsDialog::syncSettings(bool defaults, bool makeConnections)
     syncCheckbox(ui->saveRecentsCheckbox, "saverecents", defaults, makeConnections);
     // updatenotifications
     syncCheckbox(ui->updateCheckbox, "updatenotifications", defaults, makeConnections);
+    // singleinstance
+    syncCheckbox(ui->singleInstanceCheckbox, "singleinstance", defaults, makeConnections);
 }
 
 void QVOptionsDialog::syncCheckbox(QCheckBox *checkbox, const QString &key, bool defaults, bool makeConnection)
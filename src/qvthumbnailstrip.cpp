@@ -0,0 +1,142 @@
+#include "qvthumbnailstrip.h"
+#include "qvapplication.h"
+
+#include <QScrollBar>
+
+QVThumbnailModel::QVThumbnailModel(QObject *parent) : QAbstractListModel(parent)
+{
+    cellSize = 96;
+
+    connect(&qvApp->getThumbnailManager(), &ThumbnailManager::thumbnailReady, this, &QVThumbnailModel::thumbnailReady);
+}
+
+void QVThumbnailModel::setFileInfoList(const QFileInfoList &newFileInfoList)
+{
+    beginResetModel();
+    fileInfoList = newFileInfoList;
+    rowsByPath.clear();
+    rowsByPath.reserve(fileInfoList.size());
+    for (int i = 0; i < fileInfoList.size(); i++)
+        rowsByPath.insert(fileInfoList.at(i).absoluteFilePath(), i);
+    endResetModel();
+}
+
+int QVThumbnailModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    return fileInfoList.size();
+}
+
+QVariant QVThumbnailModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= fileInfoList.size())
+        return QVariant();
+
+    const QFileInfo &fileInfo = fileInfoList.at(index.row());
+    switch (role) {
+    case Qt::DecorationRole:
+    {
+        // The view only asks about cells that are on screen, so this is what keeps huge folders cheap
+        auto &thumbnailManager = qvApp->getThumbnailManager();
+        QImage thumbnail;
+        if (thumbnailManager.findThumbnail(fileInfo.absoluteFilePath(), thumbnail))
+            return thumbnail;
+
+        thumbnailManager.requestThumbnail(this, fileInfo.absoluteFilePath());
+        return QVariant();
+    }
+    case Qt::ToolTipRole:
+        return fileInfo.fileName();
+    case Qt::SizeHintRole:
+        return QSize(cellSize, cellSize);
+    default:
+        return QVariant();
+    }
+}
+
+void QVThumbnailModel::thumbnailReady(const QString &filePath)
+{
+    auto row = rowsByPath.constFind(filePath);
+    if (row == rowsByPath.constEnd())
+        return;
+
+    const QModelIndex changedIndex = index(*row);
+    emit dataChanged(changedIndex, changedIndex, {Qt::DecorationRole});
+}
+
+QVThumbnailStrip::QVThumbnailStrip(QWidget *parent) : QListView(parent)
+{
+    const int cellSize = 96;
+    folderListGeneration = 0;
+
+    thumbnailModel = new QVThumbnailModel(this);
+    thumbnailModel->setCellSize(cellSize);
+    setModel(thumbnailModel);
+
+    // Uniform cells in a single row let the view lay out any number of files without measuring them
+    setViewMode(QListView::ListMode);
+    setFlow(QListView::LeftToRight);
+    setWrapping(false);
+    setMovement(QListView::Static);
+    setUniformItemSizes(true);
+    setIconSize(QSize(cellSize, cellSize));
+    setGridSize(QSize(cellSize + 8, cellSize + 8));
+    setHorizontalScrollMode(QAbstractItemView::ScrollPerPixel);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setSelectionMode(QAbstractItemView::SingleSelection);
+    setEditTriggers(QAbstractItemView::NoEditTriggers);
+    setFixedHeight(gridSize().height() + horizontalScrollBar()->sizeHint().height() + frameWidth()*2);
+
+    scrollSettleTimer = new QTimer(this);
+    scrollSettleTimer->setSingleShot(true);
+    scrollSettleTimer->setInterval(100);
+    connect(scrollSettleTimer, &QTimer::timeout, this, &QVThumbnailStrip::cancelHiddenRequests);
+
+    connect(this, &QListView::clicked, this, [this](const QModelIndex &index){
+        emit fileActivated(index.row());
+    });
+}
+
+void QVThumbnailStrip::setFolder(const QFileInfoList &fileInfoList, quint64 generation, int currentIndex)
+{
+    // This is called on every file change, but the model is only reset when the list itself changed
+    if (generation != folderListGeneration || generation == 0)
+    {
+        folderListGeneration = generation;
+        thumbnailModel->setFileInfoList(fileInfoList);
+    }
+
+    if (currentIndex < 0 || currentIndex >= fileInfoList.size())
+    {
+        clearSelection();
+        return;
+    }
+
+    const QModelIndex index = thumbnailModel->index(currentIndex);
+    setCurrentIndex(index);
+    scrollTo(index, QAbstractItemView::PositionAtCenter);
+}
+
+void QVThumbnailStrip::cancelHiddenRequests()
+{
+    const int cellWidth = qMax(1, gridSize().width());
+    const int visibleCount = viewport()->width()/cellWidth + 1;
+    const int firstVisible = horizontalScrollBar()->value()/cellWidth;
+
+    // Keep a screen's worth on either side, those are likely to be scrolled back to
+    const QFileInfoList &fileInfoList = thumbnailModel->getFileInfoList();
+    QSet<QString> keptFiles;
+    const int lastKept = qMin(fileInfoList.size() - 1, firstVisible + visibleCount*2);
+    for (int i = qMax(0, firstVisible - visibleCount); i <= lastKept; i++)
+        keptFiles.insert(fileInfoList.at(i).absoluteFilePath());
+
+    qvApp->getThumbnailManager().cancelRequests(thumbnailModel, keptFiles);
+}
+
+void QVThumbnailStrip::scrollContentsBy(int dx, int dy)
+{
+    QListView::scrollContentsBy(dx, dy);
+    scrollSettleTimer->start();
+}
@@ -0,0 +1,59 @@
+#ifndef QVTHUMBNAILSTRIP_H
+#define QVTHUMBNAILSTRIP_H
+
+#include <QAbstractListModel>
+#include <QFileInfo>
+#include <QListView>
+#include <QTimer>
+
+class QVThumbnailModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    explicit QVThumbnailModel(QObject *parent = nullptr);
+
+    void setFileInfoList(const QFileInfoList &newFileInfoList);
+
+    const QFileInfoList &getFileInfoList() const { return fileInfoList; }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    void setCellSize(int newCellSize) { cellSize = newCellSize; }
+
+protected:
+    void thumbnailReady(const QString &filePath);
+
+private:
+    QFileInfoList fileInfoList;
+    QHash<QString, int> rowsByPath;
+
+    int cellSize;
+};
+
+class QVThumbnailStrip : public QListView
+{
+    Q_OBJECT
+public:
+    explicit QVThumbnailStrip(QWidget *parent = nullptr);
+
+    void setFolder(const QFileInfoList &fileInfoList, quint64 generation, int currentIndex);
+
+signals:
+    void fileActivated(int index);
+
+protected:
+    void cancelHiddenRequests();
+
+    void scrollContentsBy(int dx, int dy) override;
+
+private:
+    QVThumbnailModel *thumbnailModel;
+    quint64 folderListGeneration;
+
+    // Requests for cells that were scrolled past are dropped once scrolling settles down
+    QTimer *scrollSettleTimer;
+};
+
+#endif // QVTHUMBNAILSTRIP_H
@@ -153,6 +153,7 @@ void SettingsManager::initializeSettingsLibrary()
     settingsLibrary.insert("titlebaralwaysdark", {true, {}});
     settingsLibrary.insert("menubarenabled", {false, {}});
     settingsLibrary.insert("fullscreendetails", {false, {}});
+    settingsLibrary.insert("performanceoverlay", {false, {}});
     // Image
     settingsLibrary.insert("filteringenabled", {true, {}});
     settingsLibrary.insert("scalingenabled", {true, {}});
@@ -162,16 +163,20 @@ void SettingsManager::initializeSettingsLibrary()
     settingsLibrary.insert("cursorzoom", {true, {}});
     settingsLibrary.insert("cropmode", {0, {}});
     settingsLibrary.insert("pastactualsizeenabled", {true, {}});
+    settingsLibrary.insert("colormanagement", {true, {}});
     // Miscellaneous
     settingsLibrary.insert("language", {"system", {}});
     settingsLibrary.insert("sortmode", {0, {}});
     settingsLibrary.insert("sortdescending", {false, {}});
     settingsLibrary.insert("preloadingmode", {1, {}});
+    settingsLibrary.insert("preloadingbudget", {512, {}});
     settingsLibrary.insert("loopfoldersenabled", {true, {}});
+    settingsLibrary.insert("recursivebrowsing", {false, {}});
     settingsLibrary.insert("slideshowreversed", {false, {}});
     settingsLibrary.insert("slideshowtimer", {5, {}});
     settingsLibrary.insert("afterdelete", {2, {}});
     settingsLibrary.insert("askdelete", {true, {}});
     settingsLibrary.insert("saverecents", {true, {}});
     settingsLibrary.insert("updatenotifications", {false, {}});
+    settingsLibrary.insert("singleinstance", {false, {}});
 }
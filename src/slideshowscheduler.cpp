@@ -0,0 +1,143 @@
+#include "slideshowscheduler.h"
+#include "qvapplication.h"
+
+SlideshowScheduler::SlideshowScheduler(QObject *parent) : QObject(parent)
+{
+    isRunning = false;
+    interval = 5000;
+    deadline = 0;
+    isWaitingForSlide = false;
+    waitStartTime = -1;
+    slideCount = 0;
+    missedCount = 0;
+    worstLateness = 0;
+
+    // Coarse timers may fire up to 5% late, which is noticeable on long intervals
+    timer = new QTimer(this);
+    timer->setSingleShot(true);
+    timer->setTimerType(Qt::PreciseTimer);
+    connect(timer, &QTimer::timeout, this, &SlideshowScheduler::timeout);
+
+    connect(&nextSlideWatcher, &QFutureWatcher<QVImageCore::ReadData>::finished, this, &SlideshowScheduler::nextSlideFinished);
+}
+
+void SlideshowScheduler::start()
+{
+    isRunning = true;
+    isWaitingForSlide = false;
+    slideCount = 0;
+    missedCount = 0;
+    worstLateness = 0;
+
+    clock.start();
+    deadline = interval;
+    scheduleNextSlide();
+}
+
+void SlideshowScheduler::stop()
+{
+    if (!isRunning)
+        return;
+
+    isRunning = false;
+    isWaitingForSlide = false;
+    timer->stop();
+    qvApp->getImageManager().releaseRequester(this);
+
+    if (slideCount > 0)
+        qInfo().noquote() << QString("Slideshow: %1 slides, %2 missed their deadline, worst by %3 ms").arg(slideCount).arg(missedCount).arg(worstLateness);
+}
+
+void SlideshowScheduler::setInterval(int newInterval)
+{
+    const int difference = newInterval - interval;
+    interval = newInterval;
+
+    if (!isRunning)
+        return;
+
+    deadline += difference;
+    if (!isWaitingForSlide)
+        scheduleNextSlide();
+}
+
+void SlideshowScheduler::slideShown(const QString &nextFilePath)
+{
+    if (!isRunning)
+        return;
+
+    this->nextFilePath = nextFilePath;
+
+    // Start on the next slide right away, so it has the whole interval to decode.
+    // The read is shared with the preloads if they already asked for it.
+    auto &imageManager = qvApp->getImageManager();
+    QVImageCore::ReadData readData;
+    const bool isCached = nextFilePath.isEmpty() || imageManager.findCachedImage(QFileInfo(nextFilePath), readData);
+    if (!isCached)
+        nextSlideWatcher.setFuture(imageManager.requestRead(nextFilePath));
+
+    // Pinned until the slide after it comes up, or a small or disabled preloading budget
+    // would evict the decoded image right away and the tick would have to decode it again
+    imageManager.requestPreloads(this, QString(), nextFilePath.isEmpty() ? QStringList() : QStringList({nextFilePath}));
+
+    if (!isCached)
+        return;
+
+    // The user moved on to a slide that is already there while the old one was still decoding
+    nextSlideWatcher.setFuture(QFuture<QVImageCore::ReadData>());
+    if (isWaitingForSlide)
+        nextSlideFinished();
+}
+
+void SlideshowScheduler::timeout()
+{
+    // Switching now would only show a blank view until the decode finishes, so hold the current slide
+    if (nextSlideWatcher.isRunning())
+    {
+        isWaitingForSlide = true;
+        auto *monitor = PerformanceMonitor::getInstance();
+        waitStartTime = monitor ? monitor->getTimestamp() : -1;
+        return;
+    }
+
+    showNextSlide();
+}
+
+void SlideshowScheduler::nextSlideFinished()
+{
+    if (!isRunning || !isWaitingForSlide)
+        return;
+
+    isWaitingForSlide = false;
+
+    auto *monitor = PerformanceMonitor::getInstance();
+    if (monitor && monitor->getIsEnabled() && waitStartTime >= 0)
+        monitor->addEvent("slide wait", waitStartTime, monitor->getTimestamp());
+
+    showNextSlide();
+}
+
+void SlideshowScheduler::showNextSlide()
+{
+    const qint64 lateness = clock.elapsed() - deadline;
+    slideCount++;
+    if (lateness > lateTolerance)
+    {
+        missedCount++;
+        worstLateness = qMax(worstLateness, lateness);
+        qInfo().noquote() << QString("Slideshow missed its deadline by %1 ms waiting for %2").arg(lateness).arg(nextFilePath);
+    }
+
+    // A late slide still gets its full time on screen, and the ones after it are timed from there
+    deadline += interval;
+    if (deadline <= clock.elapsed())
+        deadline = clock.elapsed() + interval;
+
+    scheduleNextSlide();
+    emit advance();
+}
+
+void SlideshowScheduler::scheduleNextSlide()
+{
+    timer->start(static_cast<int>(qMax<qint64>(0, deadline - clock.elapsed())));
+}
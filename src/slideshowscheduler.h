@@ -0,0 +1,64 @@
+#ifndef SLIDESHOWSCHEDULER_H
+#define SLIDESHOWSCHEDULER_H
+
+#include "qvimagecore.h"
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QTimer>
+
+class SlideshowScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SlideshowScheduler(QObject *parent = nullptr);
+
+    void start();
+
+    void stop();
+
+    bool isActive() const { return isRunning; }
+
+    int getInterval() const { return interval; }
+
+    void setInterval(int newInterval);
+
+    void slideShown(const QString &nextFilePath);
+
+signals:
+    void advance();
+
+protected:
+    void timeout();
+
+    void nextSlideFinished();
+
+    void showNextSlide();
+
+    void scheduleNextSlide();
+
+private:
+    QTimer *timer;
+    QElapsedTimer clock;
+
+    bool isRunning;
+    int interval;
+
+    // When the next slide is due, in milliseconds of the clock, so the timer's own lateness never adds up
+    qint64 deadline;
+
+    QString nextFilePath;
+    QFutureWatcher<QVImageCore::ReadData> nextSlideWatcher;
+    bool isWaitingForSlide;
+    qint64 waitStartTime;
+
+    int slideCount;
+    int missedCount;
+    qint64 worstLateness;
+
+    // Lateness that is just the event loop being busy, not worth reporting
+    const int lateTolerance = 15;
+};
+
+#endif // SLIDESHOWSCHEDULER_H
@@ -14,7 +14,18 @@ SOURCES += \
     $$PWD/actionmanager.cpp \
     $$PWD/settingsmanager.cpp \
     $$PWD/shortcutmanager.cpp \
-    $$PWD/updatechecker.cpp
+    $$PWD/updatechecker.cpp \
+    $$PWD/imagemanager.cpp \
+    $$PWD/filelistreader.cpp \
+    $$PWD/directorywalker.cpp \
+    $$PWD/archivereader.cpp \
+    $$PWD/downloadmanager.cpp \
+    $$PWD/performancemonitor.cpp \
+    $$PWD/batchconverter.cpp \
+    $$PWD/thumbnailmanager.cpp \
+    $$PWD/qvthumbnailstrip.cpp \
+    $$PWD/qvgotodialog.cpp \
+    $$PWD/slideshowscheduler.cpp
 
 macx:!CONFIG(NO_COCOA):SOURCES += $$PWD/qvcocoafunctions.mm
 win32:!CONFIG(NO_WIN32):SOURCES += $$PWD/qvwin32functions.cpp
@@ -34,7 +45,18 @@ HEADERS += \
     $$PWD/actionmanager.h \
     $$PWD/settingsmanager.h \
     $$PWD/shortcutmanager.h \
-    $$PWD/updatechecker.h
+    $$PWD/updatechecker.h \
+    $$PWD/imagemanager.h \
+    $$PWD/filelistreader.h \
+    $$PWD/directorywalker.h \
+    $$PWD/archivereader.h \
+    $$PWD/downloadmanager.h \
+    $$PWD/performancemonitor.h \
+    $$PWD/batchconverter.h \
+    $$PWD/thumbnailmanager.h \
+    $$PWD/qvthumbnailstrip.h \
+    $$PWD/qvgotodialog.h \
+    $$PWD/slideshowscheduler.h
 
 macx:!CONFIG(NO_COCOA):HEADERS += $$PWD/qvcocoafunctions.h
 win32:!CONFIG(NO_WIN32):HEADERS += $$PWD/qvwin32functions.h
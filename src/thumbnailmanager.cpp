@@ -0,0 +1,338 @@
+#include "thumbnailmanager.h"
+#include "qvimagecore.h"
+#include "archivereader.h"
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QImageReader>
+#include <QStandardPaths>
+#include <QThread>
+#include <QtEndian>
+#include <QtConcurrent/QtConcurrentRun>
+
+ThumbnailManager::ThumbnailManager(QObject *parent) : QObject(parent)
+{
+    // At most 64 KiB each, so this stays under 64 MiB
+    thumbnailCache.setMaxCost(1000);
+
+    threadPool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+ThumbnailManager::~ThumbnailManager()
+{
+    for (const auto &pendingRequest : qAsConst(pendingRequests))
+        *pendingRequest.isCancelled = true;
+
+    threadPool.clear();
+    threadPool.waitForDone();
+}
+
+void ThumbnailManager::startDiskCachePruning()
+{
+    QtConcurrent::run(&threadPool, &ThumbnailManager::pruneDiskCache, maxDiskCacheSize, maxDiskCacheAge);
+}
+
+bool ThumbnailManager::findThumbnail(const QString &filePath, QImage &thumbnail)
+{
+    const QImage *cachedThumbnail = thumbnailCache.object(filePath);
+    if (!cachedThumbnail)
+        return false;
+
+    thumbnail = *cachedThumbnail;
+    return true;
+}
+
+void ThumbnailManager::requestThumbnail(const QObject *requester, const QString &filePath)
+{
+    if (thumbnailCache.contains(filePath) || pendingRequests.contains(filePath))
+        return;
+
+    // Tried again only once the file has changed
+    auto failedFile = failedFiles.constFind(filePath);
+    if (failedFile != failedFiles.constEnd())
+    {
+        if (*failedFile == getFileKey(filePath))
+            return;
+        failedFiles.erase(failedFile);
+    }
+
+    auto isCancelled = std::make_shared<std::atomic<bool>>(false);
+    pendingRequests.insert(filePath, {requester, isCancelled});
+
+    auto *thumbnailFutureWatcher = new QFutureWatcher<QImage>(this);
+    connect(thumbnailFutureWatcher, &QFutureWatcher<QImage>::finished, this, [thumbnailFutureWatcher, filePath, isCancelled, this](){
+        // A newer request for the same file may have replaced this one after it was cancelled
+        auto pendingRequest = pendingRequests.constFind(filePath);
+        if (pendingRequest != pendingRequests.constEnd() && pendingRequest->isCancelled == isCancelled)
+            pendingRequests.erase(pendingRequest);
+
+        const QImage thumbnail = thumbnailFutureWatcher->result();
+        thumbnailFutureWatcher->deleteLater();
+        if (isCancelled->load())
+            return;
+
+        if (thumbnail.isNull())
+        {
+            failedFiles.insert(filePath, getFileKey(filePath));
+            return;
+        }
+
+        thumbnailCache.insert(filePath, new QImage(thumbnail));
+        emit thumbnailReady(filePath);
+    });
+    thumbnailFutureWatcher->setFuture(QtConcurrent::run(&threadPool, &ThumbnailManager::readThumbnail, filePath, thumbnailSize, isCancelled));
+}
+
+void ThumbnailManager::cancelRequests(const QObject *requester, const QSet<QString> &keptFiles)
+{
+    // Queued reads return straight away once cancelled, so scrolling past thousands of files costs nothing
+    for (auto it = pendingRequests.begin(); it != pendingRequests.end();)
+    {
+        if (it->requester != requester || keptFiles.contains(it.key()))
+        {
+            ++it;
+            continue;
+        }
+
+        *it->isCancelled = true;
+        it = pendingRequests.erase(it);
+    }
+}
+
+QImage ThumbnailManager::readThumbnail(const QString &filePath, int thumbnailSize, const std::shared_ptr<std::atomic<bool>> &isCancelled)
+{
+    if (*isCancelled)
+        return QImage();
+
+    const QString diskCachePath = getDiskCachePath(filePath);
+    QImage thumbnail;
+    if (!diskCachePath.isEmpty() && thumbnail.load(diskCachePath, "png"))
+    {
+        // Pruning goes by when a thumbnail was last used, not when it was made
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+        QFile diskCacheFile(diskCachePath);
+        if (diskCacheFile.open(QIODevice::ReadWrite))
+            diskCacheFile.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+#endif
+        return thumbnail;
+    }
+
+    QBuffer encodedBuffer;
+    QImageReader imageReader;
+    imageReader.setAutoTransform(true);
+
+    QByteArray header;
+    QByteArray format;
+    if (ArchiveReader::isArchiveMember(filePath))
+    {
+        encodedBuffer.setData(QVImageCore::readEncodedFile(filePath));
+        encodedBuffer.open(QIODevice::ReadOnly);
+        imageReader.setDevice(&encodedBuffer);
+        format = QVImageCore::detectFormat(&encodedBuffer);
+        header = encodedBuffer.data().left(65540);
+    }
+    else
+    {
+        imageReader.setFileName(filePath);
+        format = QVImageCore::detectFormat(filePath);
+
+        QFile file(filePath);
+        if (format == "jpeg" && file.open(QIODevice::ReadOnly))
+            header = file.read(65540);
+    }
+
+    if (format == "apng")
+        imageReader.setFormat("png");
+    else if (!format.isEmpty())
+        imageReader.setFormat(format);
+
+    // Most cameras embed a thumbnail that's already big enough, which saves decoding the whole photo
+    if (format == "jpeg")
+    {
+        const QImage exifThumbnail = readExifThumbnail(header);
+        if (qMax(exifThumbnail.width(), exifThumbnail.height()) >= thumbnailSize)
+            thumbnail = exifThumbnail.scaled(thumbnailSize, thumbnailSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+
+    if (thumbnail.isNull())
+    {
+        // Lets the jpeg handler scale while decoding instead of decoding at full size first
+        QSize size = imageReader.size();
+        if (size.isValid() && (size.width() > thumbnailSize || size.height() > thumbnailSize))
+        {
+            size.scale(thumbnailSize, thumbnailSize, Qt::KeepAspectRatio);
+            imageReader.setScaledSize(size);
+        }
+
+        thumbnail = imageReader.read();
+        if (qMax(thumbnail.width(), thumbnail.height()) > thumbnailSize)
+            thumbnail = thumbnail.scaled(thumbnailSize, thumbnailSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+
+    if (!thumbnail.isNull() && !diskCachePath.isEmpty())
+    {
+        QDir().mkpath(QFileInfo(diskCachePath).absolutePath());
+        thumbnail.save(diskCachePath, "png");
+    }
+
+    return thumbnail;
+}
+
+QImage ThumbnailManager::readExifThumbnail(const QByteArray &header)
+{
+    const auto *data = reinterpret_cast<const uchar*>(header.constData());
+    const int dataSize = header.size();
+
+    if (dataSize < 4 || data[0] != 0xFF || data[1] != 0xD8)
+        return QImage();
+
+    // Find the APP1 segment holding the EXIF data, it comes before any image data
+    int segmentStart = 2;
+    int segmentEnd = 0;
+    while (segmentStart + 4 <= dataSize && data[segmentStart] == 0xFF)
+    {
+        const uchar marker = data[segmentStart+1];
+        const int segmentLength = (data[segmentStart+2] << 8) | data[segmentStart+3];
+        if (marker == 0xDA)
+            break;
+
+        if (marker == 0xE1 && header.mid(segmentStart+4, 6) == QByteArray("Exif\0\0", 6))
+        {
+            segmentEnd = qMin(dataSize, segmentStart + 2 + segmentLength);
+            break;
+        }
+
+        segmentStart += 2 + segmentLength;
+    }
+
+    if (segmentEnd == 0)
+        return QImage();
+
+    const int tiffStart = segmentStart + 10;
+    if (tiffStart + 8 > segmentEnd)
+        return QImage();
+
+    // Offsets in the file are unsigned 32-bit values relative to the TIFF header, so they are
+    // checked against the room left in the segment before anything is added to them
+    const qint64 tiffSize = segmentEnd - tiffStart;
+    const bool isLittleEndian = data[tiffStart] == 'I';
+    auto read16 = [&](qint64 offset) -> quint32 {
+        if (offset < 0 || offset > tiffSize - 2)
+            return 0;
+        const uchar *value = data + tiffStart + offset;
+        return isLittleEndian ? qFromLittleEndian<quint16>(value) : qFromBigEndian<quint16>(value);
+    };
+    auto read32 = [&](qint64 offset) -> quint32 {
+        if (offset < 0 || offset > tiffSize - 4)
+            return 0;
+        const uchar *value = data + tiffStart + offset;
+        return isLittleEndian ? qFromLittleEndian<quint32>(value) : qFromBigEndian<quint32>(value);
+    };
+
+    // IFD0 describes the photo and IFD1 the thumbnail
+    const qint64 firstDirectory = read32(4);
+    const qint64 firstEntryCount = read16(firstDirectory);
+    int orientation = 1;
+    for (qint64 i = 0; i < firstEntryCount; i++)
+    {
+        const qint64 entry = firstDirectory + 2 + i*12;
+        if (read16(entry) == 0x0112)
+            orientation = static_cast<int>(read16(entry + 8));
+    }
+
+    const qint64 secondDirectory = read32(firstDirectory + 2 + firstEntryCount*12);
+    if (secondDirectory == 0)
+        return QImage();
+
+    const qint64 secondEntryCount = read16(secondDirectory);
+    qint64 thumbnailOffset = 0;
+    qint64 thumbnailLength = 0;
+    for (qint64 i = 0; i < secondEntryCount; i++)
+    {
+        const qint64 entry = secondDirectory + 2 + i*12;
+        const quint32 tag = read16(entry);
+        if (tag == 0x0201)
+            thumbnailOffset = read32(entry + 8);
+        else if (tag == 0x0202)
+            thumbnailLength = read32(entry + 8);
+    }
+
+    if (thumbnailOffset <= 0 || thumbnailLength <= 0 || thumbnailOffset > tiffSize || thumbnailLength > tiffSize - thumbnailOffset)
+        return QImage();
+
+    QImage thumbnail = QImage::fromData(data + tiffStart + thumbnailOffset, static_cast<int>(thumbnailLength), "jpeg");
+
+    // Embedded thumbnails aren't transformed by the reader, so apply the photo's orientation here
+    QTransform transform;
+    switch (orientation) {
+    case 2:
+        return thumbnail.mirrored(true, false);
+    case 3:
+        return thumbnail.mirrored(true, true);
+    case 4:
+        return thumbnail.mirrored(false, true);
+    case 5:
+        return thumbnail.mirrored(true, false).transformed(transform.rotate(270));
+    case 6:
+        return thumbnail.transformed(transform.rotate(90));
+    case 7:
+        return thumbnail.mirrored(true, false).transformed(transform.rotate(90));
+    case 8:
+        return thumbnail.transformed(transform.rotate(270));
+    default:
+        return thumbnail;
+    }
+}
+
+QByteArray ThumbnailManager::getFileKey(const QString &filePath)
+{
+    // Archive members change whenever their archive does
+    QString archivePath;
+    QString memberName;
+    const QFileInfo fileInfo(ArchiveReader::splitPath(filePath, archivePath, memberName) ? archivePath : filePath);
+    if (!fileInfo.exists())
+        return QByteArray();
+
+    return filePath.toUtf8() + '\n' +
+            QByteArray::number(fileInfo.lastModified().toMSecsSinceEpoch()) + '\n' +
+            QByteArray::number(fileInfo.size());
+}
+
+QString ThumbnailManager::getDiskCachePath(const QString &filePath)
+{
+    const QString cacheLocation = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (cacheLocation.isEmpty())
+        return QString();
+
+    const QByteArray key = getFileKey(filePath);
+    if (key.isEmpty())
+        return QString();
+
+    const QString fileName = QCryptographicHash::hash(key, QCryptographicHash::Md5).toHex() + ".png";
+    return QDir(cacheLocation).filePath("thumbnails/" + fileName);
+}
+
+void ThumbnailManager::pruneDiskCache(qint64 maxSize, int maxAge)
+{
+    const QString cacheLocation = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (cacheLocation.isEmpty())
+        return;
+
+    // Thumbnails of files that were deleted or changed are never used again, so they age out here too
+    const QDateTime oldestKept = QDateTime::currentDateTime().addDays(-maxAge);
+    const QFileInfoList fileInfoList = QDir(cacheLocation + "/thumbnails").entryInfoList({"*.png"}, QDir::Files, QDir::Time);
+
+    qint64 totalSize = 0;
+    for (const auto &fileInfo : fileInfoList)
+    {
+        // Newest first, so whatever doesn't fit anymore is the least recently used
+        totalSize += fileInfo.size();
+        if (totalSize > maxSize || fileInfo.lastModified() < oldestKept)
+            QFile::remove(fileInfo.absoluteFilePath());
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef THUMBNAILMANAGER_H
+#define THUMBNAILMANAGER_H
+
+#include <QObject>
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QSet>
+#include <QThreadPool>
+#include <atomic>
+#include <memory>
+
+class ThumbnailManager : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ThumbnailManager(QObject *parent = nullptr);
+    ~ThumbnailManager() override;
+
+    void startDiskCachePruning();
+
+    bool findThumbnail(const QString &filePath, QImage &thumbnail);
+
+    void requestThumbnail(const QObject *requester, const QString &filePath);
+
+    void cancelRequests(const QObject *requester, const QSet<QString> &keptFiles);
+
+    static QImage readThumbnail(const QString &filePath, int thumbnailSize, const std::shared_ptr<std::atomic<bool>> &isCancelled);
+
+    int getThumbnailSize() const { return thumbnailSize; }
+
+signals:
+    void thumbnailReady(const QString &filePath);
+
+protected:
+    static QImage readExifThumbnail(const QByteArray &header);
+
+    static QByteArray getFileKey(const QString &filePath);
+
+    static QString getDiskCachePath(const QString &filePath);
+
+    static void pruneDiskCache(qint64 maxSize, int maxAge);
+
+private:
+    struct PendingRequest
+    {
+        const QObject *requester;
+        std::shared_ptr<std::atomic<bool>> isCancelled;
+    };
+
+    // Separate from the global pool so that thumbnails never hold up the image being viewed
+    QThreadPool threadPool;
+
+    QCache<QString, QImage> thumbnailCache;
+
+    QHash<QString, PendingRequest> pendingRequests;
+
+    // Files that couldn't be read, with the key they had then, so they aren't decoded again on every repaint
+    QHash<QString, QByteArray> failedFiles;
+
+    const int thumbnailSize = 128;
+
+    // Thumbnails on disk that weren't used for this long, or don't fit, are removed on startup
+    const qint64 maxDiskCacheSize = 256*1024*1024;
+    const int maxDiskCacheAge = 90;
+};
+
+#endif // THUMBNAILMANAGER_H
@@ -0,0 +1,18 @@
+QT += core testlib gui network widgets concurrent
+
+macx:LIBS += -framework Cocoa
+
+VERSION = 1.0
+DEFINES += "VERSION=$$VERSION"
+
+CONFIG += qt console warn_on depend_includepath testcase c++14
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+SOURCES +=  tst_benchmarks.cpp
+
+INCLUDEPATH += ../../src
+include( ../../src/src.pri )
+
+SOURCES -= $$absolute_path(../../src/main.cpp)
@@ -0,0 +1,277 @@
+#include <QtTest>
+
+#include "qvapplication.h"
+#include "qvgraphicsview.h"
+#include "qvimagecore.h"
+
+#include <QElapsedTimer>
+#include <QLinearGradient>
+#include <QPainter>
+#include <QTemporaryDir>
+
+// Synthetic folders are configured through the environment so that runs stay comparable between releases:
+//   QVIEW_BENCHMARK_COUNT    images per folder (default 50)
+//   QVIEW_BENCHMARK_SIZE     WIDTHxHEIGHT of every image (default 4000x3000)
+//   QVIEW_BENCHMARK_FORMATS  comma separated formats, one folder each (default jpg,png)
+// Results go to benchmarks.xml next to the plain text output unless -o is passed.
+
+class Benchmarks : public QObject
+{
+    Q_OBJECT
+
+public:
+    Benchmarks();
+    ~Benchmarks();
+
+private slots:
+    void initTestCase();
+
+    void readFile_data();
+    void readFile();
+
+    void scaleExpensively_data();
+    void scaleExpensively();
+
+    void updateFolderInfo_data();
+    void updateFolderInfo();
+
+    void rotateImage_data();
+    void rotateImage();
+
+    void goToFile_data();
+    void goToFile();
+
+private:
+    void addFormatRows();
+    void waitForPreloads();
+    QString getFolderPath(const QString &format) const;
+    QStringList getFilePaths(const QString &format) const;
+    void generateFolder(const QString &format);
+
+    QTemporaryDir temporaryDir;
+    int imageCount;
+    QSize imageSize;
+    QStringList formats;
+};
+
+Benchmarks::Benchmarks()
+{
+    imageCount = qEnvironmentVariableIntValue("QVIEW_BENCHMARK_COUNT");
+    if (imageCount <= 0)
+        imageCount = 50;
+
+    imageSize = QSize(4000, 3000);
+    const QStringList sizeParts = QString::fromLocal8Bit(qgetenv("QVIEW_BENCHMARK_SIZE")).split('x');
+    if (sizeParts.size() == 2 && sizeParts.at(0).toInt() > 0 && sizeParts.at(1).toInt() > 0)
+        imageSize = QSize(sizeParts.at(0).toInt(), sizeParts.at(1).toInt());
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    formats = QString::fromLocal8Bit(qgetenv("QVIEW_BENCHMARK_FORMATS")).split(',', Qt::SkipEmptyParts);
+#else
+    formats = QString::fromLocal8Bit(qgetenv("QVIEW_BENCHMARK_FORMATS")).split(',', QString::SkipEmptyParts);
+#endif
+    if (formats.isEmpty())
+        formats = QStringList({"jpg", "png"});
+}
+
+Benchmarks::~Benchmarks()
+{
+
+}
+
+void Benchmarks::initTestCase()
+{
+    QVERIFY(temporaryDir.isValid());
+
+    for (const auto &format : qAsConst(formats))
+        generateFolder(format);
+}
+
+void Benchmarks::readFile_data()
+{
+    addFormatRows();
+}
+
+void Benchmarks::readFile()
+{
+    QFETCH(QString, format);
+    const QString filePath = getFilePaths(format).constFirst();
+    const int largestDimension = qvApp->getImageManager().getLargestDimension();
+
+    QBENCHMARK {
+        const QVImageCore::ReadData readData = QVImageCore::readFile(filePath, largestDimension, true);
+        QVERIFY(!readData.image.isNull());
+    }
+}
+
+void Benchmarks::scaleExpensively_data()
+{
+    addFormatRows();
+}
+
+void Benchmarks::scaleExpensively()
+{
+    QFETCH(QString, format);
+    QVImageCore imageCore;
+    imageCore.loadPixmap(QVImageCore::readFile(getFilePaths(format).constFirst(), 0, true), false);
+    waitForPreloads();
+
+    QBENCHMARK {
+        imageCore.scaleExpensively(QSize(1920, 1080));
+    }
+}
+
+void Benchmarks::updateFolderInfo_data()
+{
+    // Listing the folder every time stays comparable with older releases, which had no listing cache
+    QTest::addColumn<QString>("format");
+    QTest::addColumn<bool>("isCached");
+
+    for (const auto &format : qAsConst(formats))
+    {
+        QTest::newRow(format.toUtf8().constData()) << format << false;
+        QTest::newRow(QString(format + " cached").toUtf8().constData()) << format << true;
+    }
+}
+
+void Benchmarks::updateFolderInfo()
+{
+    QFETCH(QString, format);
+    QFETCH(bool, isCached);
+    QVImageCore imageCore;
+    imageCore.loadPixmap(QVImageCore::readFile(getFilePaths(format).constFirst(), 0, true), false);
+    waitForPreloads();
+
+    QBENCHMARK {
+        if (!isCached)
+            imageCore.clearFolderListing();
+        imageCore.updateFolderInfo();
+    }
+    QCOMPARE(imageCore.getCurrentFileDetails().folderFileInfoList.size(), imageCount);
+}
+
+void Benchmarks::rotateImage_data()
+{
+    addFormatRows();
+}
+
+void Benchmarks::rotateImage()
+{
+    QFETCH(QString, format);
+    QVImageCore imageCore;
+    imageCore.loadPixmap(QVImageCore::readFile(getFilePaths(format).constFirst(), 0, true), false);
+    waitForPreloads();
+
+    QBENCHMARK {
+        imageCore.rotateImage(90);
+    }
+}
+
+void Benchmarks::goToFile_data()
+{
+    addFormatRows();
+}
+
+void Benchmarks::goToFile()
+{
+    QFETCH(QString, format);
+    QVGraphicsView graphicsView;
+    graphicsView.resize(1280, 720);
+    graphicsView.show();
+
+    QSignalSpy fileChangedSpy(&graphicsView, &QVGraphicsView::fileChanged);
+    graphicsView.loadFile(getFilePaths(format).constFirst());
+    QVERIFY(fileChangedSpy.wait(10000));
+
+    // Measured by hand, since loads that follow each other too closely are dropped on purpose
+    // and waiting that out shouldn't count towards the latency. The preloads each step starts
+    // are given time to finish as well, like a user looking at the image before moving on.
+    qint64 totalTime = 0;
+    for (int i = 1; i < imageCount; i++)
+    {
+        QTest::qWait(100);
+        waitForPreloads();
+        fileChangedSpy.clear();
+
+        QElapsedTimer latencyTimer;
+        latencyTimer.start();
+        graphicsView.goToFile(QVGraphicsView::GoToFileMode::next);
+        if (fileChangedSpy.isEmpty())
+            QVERIFY(fileChangedSpy.wait(10000));
+        totalTime += latencyTimer.nsecsElapsed();
+    }
+
+    QTest::setBenchmarkResult(static_cast<qreal>(totalTime)/qMax(1, imageCount - 1)/1000000, QTest::WalltimeMilliseconds);
+}
+
+void Benchmarks::addFormatRows()
+{
+    QTest::addColumn<QString>("format");
+
+    for (const auto &format : qAsConst(formats))
+        QTest::newRow(format.toUtf8().constData()) << format;
+}
+
+void Benchmarks::waitForPreloads()
+{
+    // Otherwise the background decodes started by loading compete with whatever is measured next
+    QTRY_COMPARE_WITH_TIMEOUT(qvApp->getImageManager().getPendingReadCount(), 0, 60000);
+}
+
+QString Benchmarks::getFolderPath(const QString &format) const
+{
+    return temporaryDir.filePath(format);
+}
+
+QStringList Benchmarks::getFilePaths(const QString &format) const
+{
+    QStringList filePaths;
+    for (int i = 0; i < imageCount; i++)
+        filePaths.append(QDir(getFolderPath(format)).filePath(QString("image%1.%2").arg(i, 4, 10, QChar('0')).arg(format)));
+    return filePaths;
+}
+
+void Benchmarks::generateFolder(const QString &format)
+{
+    QVERIFY(QDir().mkpath(getFolderPath(format)));
+
+    const QStringList filePaths = getFilePaths(format);
+    for (int i = 0; i < filePaths.size(); i++)
+    {
+        // Smooth gradients with some detail on top, so the encoders have something realistic to chew on
+        QImage image(imageSize, QImage::Format_RGB32);
+        QPainter painter(&image);
+        QLinearGradient gradient(0, 0, imageSize.width(), imageSize.height());
+        gradient.setColorAt(0, QColor::fromHsv((i*37) % 360, 200, 220));
+        gradient.setColorAt(1, QColor::fromHsv((i*37 + 180) % 360, 120, 60));
+        painter.fillRect(image.rect(), gradient);
+        painter.setPen(QPen(Qt::white, 3));
+        for (int line = 0; line < 200; line++)
+        {
+            const int x = (line*7919 + i*104729) % imageSize.width();
+            const int y = (line*6271 + i*130363) % imageSize.height();
+            painter.drawEllipse(QPoint(x, y), 10 + line % 90, 10 + line % 60);
+        }
+        painter.end();
+
+        QVERIFY2(image.save(filePaths.at(i), format.toLatin1().constData()), qPrintable(filePaths.at(i)));
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    // Runs the same way on build machines without a display
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QVApplication app(argc, argv);
+    Benchmarks benchmarks;
+
+    QStringList arguments = app.arguments();
+    if (!arguments.contains("-o"))
+        arguments << "-o" << "benchmarks.xml,xml" << "-o" << "-,txt";
+
+    return QTest::qExec(&benchmarks, arguments);
+}
+
+#include "tst_benchmarks.moc"
@@ -1,4 +1,4 @@
-QT += core testlib gui network widgets
+QT += core testlib gui network widgets concurrent
 
 macx:LIBS += -framework Cocoa
 
@@ -10,7 +10,12 @@ CONFIG -= app_bundle
 
 TEMPLATE = app
 
-SOURCES +=  tst_actionmanagertests.cpp
+SOURCES +=  tst_actionmanagertests.cpp \
+    tst_imagecoretests.cpp \
+    tst_archivereadertests.cpp
+
+HEADERS += tst_imagecoretests.h \
+    tst_archivereadertests.h
 
 INCLUDEPATH += ../src
 include( ../src/src.pri )
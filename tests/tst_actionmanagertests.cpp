@@ -1,6 +1,8 @@
 #include <QtTest>
 
 #include "qvapplication.h"
+#include "tst_imagecoretests.h"
+#include "tst_archivereadertests.h"
 
 class ActionManagerTests : public QObject
 {
@@ -49,8 +51,19 @@ void ActionManagerTests::testClonedActionsUntracked()
 int main(int argc, char *argv[])
 {
     QVApplication app(argc, argv);
+
+    int status = 0;
+
     ActionManagerTests actionManagerTests;
-    return QTest::qExec(&actionManagerTests, argc, argv);
+    status |= QTest::qExec(&actionManagerTests, argc, argv);
+
+    ImageCoreTests imageCoreTests;
+    status |= QTest::qExec(&imageCoreTests, argc, argv);
+
+    ArchiveReaderTests archiveReaderTests;
+    status |= QTest::qExec(&archiveReaderTests, argc, argv);
+
+    return status;
 }
 
 #include "tst_actionmanagertests.moc"
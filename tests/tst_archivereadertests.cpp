@@ -0,0 +1,225 @@
+#include "tst_archivereadertests.h"
+
+#include "archivereader.h"
+
+#include <QtTest>
+#include <QtEndian>
+
+namespace
+{
+    void appendUInt16(QByteArray &data, quint16 value)
+    {
+        char bytes[2];
+        qToLittleEndian(value, bytes);
+        data.append(bytes, 2);
+    }
+
+    void appendUInt32(QByteArray &data, quint32 value)
+    {
+        char bytes[4];
+        qToLittleEndian(value, bytes);
+        data.append(bytes, 4);
+    }
+
+    void appendUInt64(QByteArray &data, quint64 value)
+    {
+        char bytes[8];
+        qToLittleEndian(value, bytes);
+        data.append(bytes, 8);
+    }
+
+    const QList<QPair<QByteArray, QByteArray>> testMembers = {
+        {"first.txt", "first member"},
+        {"folder/second.txt", "the second member"}
+    };
+}
+
+void ArchiveReaderTests::initTestCase()
+{
+    QVERIFY(temporaryDir.isValid());
+}
+
+void ArchiveReaderTests::testZipMembers_data()
+{
+    QTest::addColumn<bool>("isZip64");
+
+    QTest::newRow("zip") << false;
+    QTest::newRow("zip64") << true;
+}
+
+void ArchiveReaderTests::testZipMembers()
+{
+    QFETCH(bool, isZip64);
+
+    const QString archivePath = createFile(QString("%1.zip").arg(QTest::currentDataTag()), createZip(testMembers, isZip64));
+
+    QCOMPARE(ArchiveReader::getMemberNames(archivePath), QStringList({"first.txt", "folder/second.txt"}));
+    for (const auto &member : testMembers)
+        QCOMPARE(ArchiveReader::readMember(archivePath, member.first), member.second);
+
+    QVERIFY(ArchiveReader::readMember(archivePath, "missing.txt").isNull());
+}
+
+void ArchiveReaderTests::testTarMembers()
+{
+    // Longer than the 100 bytes the header has room for, so it goes in a GNU long name entry
+    const QByteArray longName = QByteArray(120, 'n') + ".txt";
+    QList<QPair<QByteArray, QByteArray>> members = testMembers;
+    members.append({longName, "a member with a long name"});
+
+    const QString archivePath = createFile("test.tar", createTar(members));
+
+    QCOMPARE(ArchiveReader::getMemberNames(archivePath), QStringList({"first.txt", "folder/second.txt", QString::fromLatin1(longName)}));
+    for (const auto &member : qAsConst(members))
+        QCOMPARE(ArchiveReader::readMember(archivePath, QString::fromLatin1(member.first)), member.second);
+}
+
+void ArchiveReaderTests::testSplitPath()
+{
+    const QString archivePath = createFile("split/comic.cbz", createZip(testMembers, false));
+
+    QString splitArchivePath;
+    QString memberName;
+    QVERIFY(ArchiveReader::splitPath(archivePath + "/folder/second.txt", splitArchivePath, memberName));
+    QCOMPARE(splitArchivePath, archivePath);
+    QCOMPARE(memberName, QString("folder/second.txt"));
+
+    // Answered from the cache the second time, which has to give the same result
+    QVERIFY(ArchiveReader::splitPath(archivePath + "/first.txt", splitArchivePath, memberName));
+    QCOMPARE(memberName, QString("first.txt"));
+
+    // A folder named like an archive is just a folder
+    const QString folderPath = createFile("split/folder.zip/image.png", QByteArray("not an archive"));
+    QVERIFY(!ArchiveReader::splitPath(folderPath, splitArchivePath, memberName));
+
+    QVERIFY(!ArchiveReader::splitPath(temporaryDir.filePath("split/image.png"), splitArchivePath, memberName));
+    QVERIFY(!ArchiveReader::splitPath(archivePath, splitArchivePath, memberName));
+}
+
+QString ArchiveReaderTests::createFile(const QString &relativePath, const QByteArray &data)
+{
+    const QString filePath = temporaryDir.filePath(relativePath);
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+
+    QFile file(filePath);
+    if (file.open(QIODevice::WriteOnly))
+        file.write(data);
+    return filePath;
+}
+
+QByteArray ArchiveReaderTests::createZip(const QList<QPair<QByteArray, QByteArray>> &members, bool isZip64)
+{
+    // Stored members only, so the reader doesn't need zlib to get them back
+    QByteArray archive;
+    QByteArray directory;
+    for (const auto &member : members)
+    {
+        const quint32 offset = static_cast<quint32>(archive.size());
+        const quint32 size = static_cast<quint32>(member.second.size());
+
+        appendUInt32(archive, 0x04034b50);
+        appendUInt16(archive, 20);
+        appendUInt16(archive, 0);
+        appendUInt16(archive, 0);
+        appendUInt32(archive, 0);
+        appendUInt32(archive, 0);
+        appendUInt32(archive, size);
+        appendUInt32(archive, size);
+        appendUInt16(archive, static_cast<quint16>(member.first.size()));
+        appendUInt16(archive, 0);
+        archive.append(member.first);
+        archive.append(member.second);
+
+        // Zip64 central directory entries leave the real values to the extra field
+        appendUInt32(directory, 0x02014b50);
+        appendUInt16(directory, 45);
+        appendUInt16(directory, 45);
+        appendUInt16(directory, 0);
+        appendUInt16(directory, 0);
+        appendUInt32(directory, 0);
+        appendUInt32(directory, 0);
+        appendUInt32(directory, isZip64 ? 0xFFFFFFFF : size);
+        appendUInt32(directory, isZip64 ? 0xFFFFFFFF : size);
+        appendUInt16(directory, static_cast<quint16>(member.first.size()));
+        appendUInt16(directory, isZip64 ? 28 : 0);
+        appendUInt16(directory, 0);
+        appendUInt16(directory, 0);
+        appendUInt16(directory, 0);
+        appendUInt32(directory, 0);
+        appendUInt32(directory, isZip64 ? 0xFFFFFFFF : offset);
+        directory.append(member.first);
+        if (isZip64)
+        {
+            appendUInt16(directory, 0x0001);
+            appendUInt16(directory, 24);
+            appendUInt64(directory, size);
+            appendUInt64(directory, size);
+            appendUInt64(directory, offset);
+        }
+    }
+
+    const quint32 directoryOffset = static_cast<quint32>(archive.size());
+    const quint32 directorySize = static_cast<quint32>(directory.size());
+    archive.append(directory);
+
+    if (isZip64)
+    {
+        const quint64 zip64EndRecordOffset = static_cast<quint64>(archive.size());
+        appendUInt32(archive, 0x06064b50);
+        appendUInt64(archive, 44);
+        appendUInt16(archive, 45);
+        appendUInt16(archive, 45);
+        appendUInt32(archive, 0);
+        appendUInt32(archive, 0);
+        appendUInt64(archive, static_cast<quint64>(members.size()));
+        appendUInt64(archive, static_cast<quint64>(members.size()));
+        appendUInt64(archive, directorySize);
+        appendUInt64(archive, directoryOffset);
+
+        appendUInt32(archive, 0x07064b50);
+        appendUInt32(archive, 0);
+        appendUInt64(archive, zip64EndRecordOffset);
+        appendUInt32(archive, 1);
+    }
+
+    appendUInt32(archive, 0x06054b50);
+    appendUInt16(archive, 0);
+    appendUInt16(archive, 0);
+    appendUInt16(archive, static_cast<quint16>(members.size()));
+    appendUInt16(archive, static_cast<quint16>(members.size()));
+    appendUInt32(archive, isZip64 ? 0xFFFFFFFF : directorySize);
+    appendUInt32(archive, isZip64 ? 0xFFFFFFFF : directoryOffset);
+    appendUInt16(archive, 0);
+
+    return archive;
+}
+
+QByteArray ArchiveReaderTests::createTar(const QList<QPair<QByteArray, QByteArray>> &members)
+{
+    auto appendEntry = [](QByteArray &archive, const QByteArray &name, char type, const QByteArray &data) {
+        QByteArray header(512, '\0');
+        header.replace(0, qMin(name.size(), 100), name.left(100));
+        header.replace(100, 7, "0000644");
+        header.replace(124, 11, QByteArray::number(data.size(), 8).rightJustified(11, '0'));
+        header[156] = type;
+        header.replace(257, 6, QByteArray("ustar\0", 6));
+        header.replace(263, 2, "00");
+        archive.append(header);
+
+        archive.append(data);
+        archive.append(QByteArray((512 - data.size() % 512) % 512, '\0'));
+    };
+
+    QByteArray archive;
+    for (const auto &member : members)
+    {
+        if (member.first.size() > 100)
+            appendEntry(archive, "././@LongLink", 'L', member.first + '\0');
+
+        appendEntry(archive, member.first, '0', member.second);
+    }
+
+    // Two empty blocks end the archive
+    archive.append(QByteArray(1024, '\0'));
+    return archive;
+}
@@ -0,0 +1,31 @@
+#ifndef TST_ARCHIVEREADERTESTS_H
+#define TST_ARCHIVEREADERTESTS_H
+
+#include <QObject>
+#include <QTemporaryDir>
+
+class ArchiveReaderTests : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void testZipMembers_data();
+    void testZipMembers();
+
+    void testTarMembers();
+
+    void testSplitPath();
+
+private:
+    QString createFile(const QString &relativePath, const QByteArray &data);
+
+    static QByteArray createZip(const QList<QPair<QByteArray, QByteArray>> &members, bool isZip64);
+
+    static QByteArray createTar(const QList<QPair<QByteArray, QByteArray>> &members);
+
+    QTemporaryDir temporaryDir;
+};
+
+#endif // TST_ARCHIVEREADERTESTS_H
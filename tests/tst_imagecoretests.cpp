@@ -0,0 +1,96 @@
+#include "tst_imagecoretests.h"
+
+#include "qvapplication.h"
+#include "qvgraphicsview.h"
+
+#include <QtTest>
+#include <QBuffer>
+
+void ImageCoreTests::initTestCase()
+{
+    QVERIFY(temporaryDir.isValid());
+}
+
+void ImageCoreTests::testPlaylistReplacesLoadedImage()
+{
+    const QString shownFile = createImage("a/shown.png");
+    const QStringList playlistFiles = {createImage("b/first.png"), createImage("c/second.png")};
+
+    QVGraphicsView graphicsView;
+    QSignalSpy fileChangedSpy(&graphicsView, &QVGraphicsView::fileChanged);
+    graphicsView.loadFile(shownFile);
+    QVERIFY(fileChangedSpy.wait(10000));
+
+    // Loads that follow each other too closely are dropped on purpose
+    QTest::qWait(100);
+    fileChangedSpy.clear();
+
+    // Files from two different folders can only end up together through the playlist
+    graphicsView.loadFiles(playlistFiles);
+    if (fileChangedSpy.isEmpty())
+        QVERIFY(fileChangedSpy.wait(10000));
+
+    const auto &fileDetails = graphicsView.getCurrentFileDetails();
+    QCOMPARE(fileDetails.fileInfo.absoluteFilePath(), QFileInfo(playlistFiles.at(0)).absoluteFilePath());
+    QCOMPARE(fileDetails.folderFileInfoList.size(), 2);
+    QCOMPARE(fileDetails.folderFileInfoList.at(1).absoluteFilePath(), QFileInfo(playlistFiles.at(1)).absoluteFilePath());
+    QCOMPARE(fileDetails.loadedIndexInFolder, 0);
+}
+
+void ImageCoreTests::testDetectFormat_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<QByteArray>("format");
+
+    const QByteArray pngSignature("\x89PNG\r\n\x1a\n");
+    const QByteArray headerChunk = QByteArray("\0\0\0\x0dIHDR", 8) + QByteArray(13 + 4, '\0');
+    const QByteArray animationChunk = QByteArray("\0\0\0\x08" "acTL", 8) + QByteArray(8 + 4, '\0');
+    const QByteArray dataChunk = QByteArray("\0\0\0\0IDAT", 8) + QByteArray(4, '\0');
+
+    QTest::newRow("png") << pngSignature + headerChunk + dataChunk << QByteArray("png");
+    QTest::newRow("apng") << pngSignature + headerChunk + animationChunk + dataChunk << QByteArray("apng");
+    QTest::newRow("jpeg") << QByteArray("\xff\xd8\xff\xe0") + QByteArray(16, '\0') << QByteArray("jpeg");
+    QTest::newRow("gif") << QByteArray("GIF89a") + QByteArray(16, '\0') << QByteArray("gif");
+    QTest::newRow("webp") << QByteArray("RIFF\0\0\0\0WEBPVP8 ", 16) << QByteArray("webp");
+
+    // One 16x16 image right after the directory
+    auto iconHeader = [](char type) {
+        QByteArray header("\0\0", 2);
+        header += type;
+        header += QByteArray("\0\1\0", 3);
+        header += QByteArray("\x10\x10\0\0\0\0\0\0\x04\0\0\0\x16\0\0\0", 16);
+        return header + QByteArray(4, '\0');
+    };
+    QTest::newRow("ico") << iconHeader(1) << QByteArray("ico");
+    QTest::newRow("cur") << iconHeader(2) << QByteArray("cur");
+
+    // An uncompressed true colour tga starts like a cursor, but has no directory, so it is left to the plugins
+    const QByteArray tgaHeader("\0\0\x02\0\0\0\0\0\0\0\0\0\x10\0\x10\0\x18\0", 18);
+    QTest::newRow("tga") << tgaHeader + QByteArray(16*16*3, '\0') << QByteArray();
+
+    QTest::newRow("unknown") << QByteArray("just some text") << QByteArray();
+}
+
+void ImageCoreTests::testDetectFormat()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(QByteArray, format);
+
+    QBuffer buffer(&data);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    QCOMPARE(QVImageCore::detectFormat(&buffer), format);
+
+    // Whoever reads the image next still starts at the beginning
+    QCOMPARE(buffer.pos(), qint64(0));
+}
+
+QString ImageCoreTests::createImage(const QString &relativePath)
+{
+    const QString filePath = temporaryDir.filePath(relativePath);
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+
+    QImage image(16, 16, QImage::Format_RGB32);
+    image.fill(Qt::darkCyan);
+    image.save(filePath, "png");
+    return filePath;
+}
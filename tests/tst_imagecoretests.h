@@ -0,0 +1,25 @@
+#ifndef TST_IMAGECORETESTS_H
+#define TST_IMAGECORETESTS_H
+
+#include <QObject>
+#include <QTemporaryDir>
+
+class ImageCoreTests : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void testPlaylistReplacesLoadedImage();
+
+    void testDetectFormat_data();
+    void testDetectFormat();
+
+private:
+    QString createImage(const QString &relativePath);
+
+    QTemporaryDir temporaryDir;
+};
+
+#endif // TST_IMAGECORETESTS_H